@@ -0,0 +1,199 @@
+/// @file       archive.cpp
+/// @brief      Definition of modgraph::archive_writer and
+///             modgraph::archive_reader.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "archive.hpp"
+#include <cerrno> // errno
+#include <cstring> // memcpy, memcmp, strerror
+#include <fcntl.h> // open
+#include <iostream> // cerr, endl
+#include <sys/file.h> // flock
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close, pread, pwrite, ftruncate
+#include <vector> // vector
+
+using std::string;
+
+
+namespace modgraph {
+
+
+/// First bytes of every archive.
+constexpr char ARC_MAGIC[8]= {'m', 'o', 'd', 'g', 'a', 'r', 'c', '1'};
+
+
+/// Write whole buffer at offset, despite partial writes.
+/// @param fd  Descriptor of file.
+/// @param buf  Buffer.
+/// @param n  Number of bytes.
+/// @param off  Offset in file.
+/// @return  True on success.
+static bool write_at(int fd, void const *buf, std::size_t n, off_t off) {
+  char const *p= static_cast<char const *>(buf);
+  while(n > 0) {
+    ssize_t const k= pwrite(fd, p, n, off);
+    if(k < 0 && errno == EINTR) continue;
+    if(k <= 0) return false;
+    p+= k;
+    n-= k;
+    off+= k;
+  }
+  return true;
+}
+
+
+/// Exclusive lock on file among processes, released on destruction.
+struct file_lock {
+  int const fd; ///< Descriptor of locked file.
+
+  /// Lock file.
+  /// @param f  Descriptor of file.
+  file_lock(int f): fd(f) {
+    while(flock(fd, LOCK_EX) && errno == EINTR) {}
+  }
+
+  /// Unlock file.
+  ~file_lock() { flock(fd, LOCK_UN); }
+};
+
+
+archive_writer::archive_writer(
+    string const &path, layout_key const &k, int capacity):
+    fd_(open(path.c_str(), O_RDWR | O_CREAT, 0644)), capacity_(capacity) {
+  if(fd_ < 0) {
+    std::cerr << path << ": " << std::strerror(errno) << std::endl;
+    throw "cannot open archive";
+  }
+  char const *error= nullptr;
+  {
+    file_lock const lock(fd_);
+    struct stat st;
+    archive_header h{};
+    if(fstat(fd_, &st)) {
+      error= "cannot read archive";
+    } else if(st.st_size == 0) {
+      // New archive gets header and empty index.
+      std::memcpy(h.magic, ARC_MAGIC, sizeof(ARC_MAGIC));
+      h.capacity= capacity_;
+      h.edge_attract= k.edge_attract;
+      h.sum_attract= k.sum_attract;
+      h.factor_attract= k.factor_attract;
+      h.theta= k.theta;
+      off_t const end= sizeof(h) + sizeof(uint64_t) * capacity_;
+      if(ftruncate(fd_, end) || !write_at(fd_, &h, sizeof(h), 0)) {
+        error= "cannot write archive";
+      }
+    } else if(pread(fd_, &h, sizeof(h), 0) != ssize_t(sizeof(h)) ||
+              std::memcmp(h.magic, ARC_MAGIC, sizeof(ARC_MAGIC)) != 0) {
+      error= "not an archive";
+    } else if(h.edge_attract != k.edge_attract ||
+              h.sum_attract != k.sum_attract ||
+              h.factor_attract != k.factor_attract || h.theta != k.theta) {
+      error= "archive holds layouts for other parameters";
+    } else {
+      capacity_= h.capacity;
+    }
+  }
+  if(error) {
+    close(fd_);
+    throw error;
+  }
+}
+
+
+archive_writer::~archive_writer() { close(fd_); }
+
+
+void archive_writer::append(layout_result const &r) {
+  int const n= r.modulus;
+  if(n < 0 || n >= capacity_) throw "modulus beyond index of archive";
+  archive_record const h{n, r.iterations, int32_t(r.converged), 0,
+      r.potential};
+  std::size_t const bytes= sizeof(h) + (3 * sizeof(float) + 4) * n;
+  std::vector<char> buf(bytes);
+  std::memcpy(buf.data(), &h, sizeof(h));
+  float *pos= reinterpret_cast<float *>(buf.data() + sizeof(h));
+  for(int i= 0; i < 3 * n; ++i) pos[i]= float(r.positions.data()[i]);
+  int32_t *next= reinterpret_cast<int32_t *>(pos + 3 * n);
+  for(int i= 0; i < n; ++i) next[i]= i; // Fixed point of squaring.
+  for(edge const &e: r.edges) next[e[0]]= e[1];
+  off_t off;
+  {
+    std::lock_guard<std::mutex> const guard(mutex_);
+    file_lock const lock(fd_);
+    struct stat st;
+    if(fstat(fd_, &st)) throw "cannot read archive";
+    off= (st.st_size + 7) & ~off_t(7);
+    if(ftruncate(fd_, off + bytes)) throw "cannot extend archive";
+  }
+  uint64_t const slot= off;
+  off_t const where= sizeof(archive_header) + sizeof(uint64_t) * n;
+  if(!write_at(fd_, buf.data(), bytes, off) ||
+     !write_at(fd_, &slot, sizeof(slot), where)) {
+    throw "cannot write archive";
+  }
+}
+
+
+archive_reader::archive_reader(string const &path) {
+  int const fd= open(path.c_str(), O_RDONLY);
+  if(fd < 0) {
+    std::cerr << path << ": " << std::strerror(errno) << std::endl;
+    throw "cannot open archive";
+  }
+  struct stat st;
+  if(fstat(fd, &st)) {
+    close(fd);
+    throw "cannot read archive";
+  }
+  size_= st.st_size;
+  map_= (size_ ? mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0)
+               : MAP_FAILED);
+  close(fd); // Mapping outlives descriptor.
+  if(map_ == MAP_FAILED) throw "cannot map archive";
+  header_= static_cast<archive_header const *>(map_);
+  index_= reinterpret_cast<uint64_t const *>(header_ + 1);
+  if(size_ < sizeof(archive_header) ||
+     std::memcmp(header_->magic, ARC_MAGIC, sizeof(ARC_MAGIC)) != 0 ||
+     size_ < sizeof(archive_header) +
+                 sizeof(uint64_t) * std::size_t(header_->capacity)) {
+    munmap(map_, size_);
+    throw "not an archive";
+  }
+}
+
+
+archive_reader::~archive_reader() { munmap(map_, size_); }
+
+
+layout_key archive_reader::params() const {
+  return {0,
+      header_->edge_attract,
+      header_->sum_attract,
+      header_->factor_attract,
+      header_->theta};
+}
+
+
+bool archive_reader::find(int m, archived_layout &a) const {
+  if(m < 0 || m >= header_->capacity) return false;
+  uint64_t const off= index_[m];
+  if(off == 0 || off + sizeof(archive_record) > size_) return false;
+  char const *p= static_cast<char const *>(map_) + off;
+  auto const *h= reinterpret_cast<archive_record const *>(p);
+  if(h->modulus != m) return false;
+  if(off + sizeof(*h) + (3 * sizeof(float) + 4) * uint64_t(m) > size_) {
+    return false;
+  }
+  a.record= h;
+  a.positions= reinterpret_cast<float const *>(h + 1);
+  a.next= reinterpret_cast<int32_t const *>(a.positions + 3 * m);
+  return true;
+}
+
+
+} // namespace modgraph
+
+// EOF
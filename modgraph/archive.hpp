@@ -0,0 +1,143 @@
+/// @file       archive.hpp
+/// @brief      Declaration of modgraph::archive_writer and
+///             modgraph::archive_reader.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+///
+/// Single file holding layouts of many moduli, to be read through mmap.
+/// - File begins with archive_header, which is followed by index of
+///   `capacity` offsets (uint64_t), one per modulus; offset of absent
+///   modulus is zero.
+/// - Each record, at offset of multiple of 8, begins with archive_record,
+///   which is followed by 3N floats (x, y, and z of each node in turn) and
+///   by N successors (int32_t).
+/// - Numbers are stored in byte-order of host.
+
+#pragma once
+
+#include "layout-cache.hpp" // layout_key
+#include "layout.hpp" // layout_result
+#include <cstddef> // size_t
+#include <cstdint> // int32_t, uint64_t
+#include <mutex> // mutex
+#include <string> // string
+
+namespace modgraph {
+
+
+/// Header at start of archive.
+struct archive_header {
+  char magic[8]; ///< "modgarc1".
+  int32_t capacity; ///< Number of slots in index; largest modulus plus 1.
+  int32_t reserved; ///< Zero.
+  double edge_attract; ///< Scale of attraction along directed edge.
+  double sum_attract; ///< Relative scale of attraction by sum.
+  double factor_attract; ///< Relative scale of attraction by factor.
+  double theta; ///< Opening angle for approximate repulsion (0 if exact).
+};
+
+
+/// Header at start of each record in archive.
+struct archive_record {
+  int32_t modulus; ///< Modulus, equal to number N of nodes.
+  int32_t iterations; ///< Number of iterations of minimizer.
+  int32_t converged; ///< 1 if minimizer converged, or else 0.
+  int32_t reserved; ///< Zero.
+  double potential; ///< Potential at final positions.
+};
+
+
+/// Layout in archive, pointing into mapping of file.
+struct archived_layout {
+  archive_record const *record; ///< Header of record.
+  float const *positions; ///< 3N coordinates, node by node.
+  int32_t const *next; ///< Successor of every node.
+};
+
+
+/// Writer that appends layouts to archive.
+/// - Several threads may share one writer, and several processes may
+///   append to same archive at once: space for each record is reserved
+///   under lock, and record is written outside lock; slot in index is
+///   written last, so that partial record is never visible to reader.
+/// - Layout appended again for same modulus replaces original in index;
+///   space of original is not reclaimed.
+class archive_writer {
+public:
+  /// Default number of slots in index, enough for every modulus of up to
+  /// six figures.
+  /// - Index of new archive is sparse part of file, whose unused slots
+  ///   occupy no space on disk.
+  static constexpr int DEFAULT_CAPACITY= 1 << 20;
+
+private:
+  int fd_; ///< Descriptor of archive.
+  int capacity_; ///< Number of slots in index.
+  std::mutex mutex_; ///< Lock for reservation among threads.
+
+public:
+  /// Open archive, creating it if necessary.
+  /// - Exception of type `char const*` is thrown if file be not archive, or
+  ///   if archive hold layouts for other parameters.
+  /// @param path  Path of archive.
+  /// @param k  Parameters of potential (modulus ignored).
+  /// @param capacity  Number of slots in index of new archive; ignored for
+  ///                  existing archive.
+  archive_writer(std::string const &path,
+      layout_key const &k,
+      int capacity= DEFAULT_CAPACITY);
+
+  archive_writer(archive_writer const &)= delete;
+  archive_writer &operator=(archive_writer const &)= delete;
+
+  /// Close archive.
+  ~archive_writer();
+
+  /// Number of slots in index.
+  /// @return  Largest modulus that can be archived, plus 1.
+  int capacity() const { return capacity_; }
+
+  /// Append layout.
+  /// - Exception of type `char const*` is thrown if modulus exceed
+  ///   capacity or if write fail.
+  /// @param r  Layout.
+  void append(layout_result const &r);
+};
+
+
+/// Reader that maps archive into memory.
+/// - Each lookup costs one load from index; nothing is parsed or copied.
+/// - Only layouts wholly within file as it was on opening are found.
+class archive_reader {
+  void *map_; ///< Mapping of archive.
+  std::size_t size_; ///< Size of mapping in bytes.
+  archive_header const *header_; ///< Header at start of mapping.
+  uint64_t const *index_; ///< Offset of each modulus's record.
+
+public:
+  /// Map archive.
+  /// - Exception of type `char const*` is thrown if file cannot be mapped
+  ///   or be not archive.
+  /// @param path  Path of archive.
+  archive_reader(std::string const &path);
+
+  archive_reader(archive_reader const &)= delete;
+  archive_reader &operator=(archive_reader const &)= delete;
+
+  /// Unmap archive.
+  ~archive_reader();
+
+  /// Parameters of potential for every layout in archive.
+  /// @return  Key whose modulus is zero.
+  layout_key params() const;
+
+  /// Find layout for modulus.
+  /// @param m  Modulus.
+  /// @param a  On successful return, layout.
+  /// @return  True if archive hold layout for modulus.
+  bool find(int m, archived_layout &a) const;
+};
+
+
+} // namespace modgraph
+
+// EOF
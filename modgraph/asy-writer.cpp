@@ -0,0 +1,154 @@
+/// @file       asy-writer.cpp
+/// @brief      Definition of modgraph::asy_writer and
+///             modgraph::write_asy().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "asy-writer.hpp"
+#include <algorithm> // copy, min
+#include <charconv> // to_chars
+#include <cstdio> // snprintf
+#include <cstring> // strlen
+
+using Eigen::Vector3d;
+using std::string;
+
+
+namespace modgraph {
+
+
+void asy_writer::flush() {
+  ofs_.write(buf_.data(), len_);
+  len_= 0;
+}
+
+
+asy_writer &asy_writer::put(string const &s) {
+  char const *p= s.data();
+  unsigned n= s.size();
+  while(n > 0) {
+    if(len_ == buf_.size()) flush();
+    unsigned const k= std::min<unsigned>(n, buf_.size() - len_);
+    std::copy(p, p + k, buf_.data() + len_);
+    len_+= k;
+    p+= k;
+    n-= k;
+  }
+  return *this;
+}
+
+
+asy_writer &asy_writer::put(char const *s) {
+  unsigned const n= std::strlen(s);
+  if(n > SLACK) return put(string(s));
+  reserve();
+  std::copy(s, s + n, buf_.data() + len_);
+  len_+= n;
+  return *this;
+}
+
+
+asy_writer &asy_writer::put(double v) {
+  reserve();
+  char *const b= buf_.data() + len_;
+#if defined(__cpp_lib_to_chars)
+  len_= std::to_chars(b, b + SLACK, v, std::chars_format::general, 6).ptr -
+        buf_.data();
+#else
+  // Library lacks floating-point to_chars (for example, before gcc-11).
+  len_+= std::snprintf(b, SLACK, "%g", v);
+#endif
+  return *this;
+}
+
+
+asy_writer &asy_writer::put(int i) {
+  reserve();
+  char *const b= buf_.data() + len_;
+  len_= std::to_chars(b, b + SLACK, i).ptr - buf_.data();
+  return *this;
+}
+
+
+asy_writer &asy_writer::put(Vector3d const &v) {
+  return put("(").put(v[0]).put(",").put(v[1]).put(",").put(v[2]).put(")");
+}
+
+
+asy_writer::asy_writer(string const &path): ofs_(path), buf_(BLOCK) {
+  if(!ofs_) throw "cannot open asy-file";
+}
+
+
+asy_writer::~asy_writer() {
+  if(ofs_.is_open()) flush();
+}
+
+
+void asy_writer::close() {
+  flush();
+  ofs_.close();
+  if(!ofs_) throw "cannot write asy-file";
+}
+
+
+void asy_writer::header(
+    string const &ofmt, string const &prc, double unit_cm) {
+  put("settings.outformat = \"").put(ofmt).put("\";\n");
+  put("settings.prc = ").put(prc).put(";\n");
+  put("settings.render = 8;\n");
+  put("unitsize(").put(unit_cm).put("cm);\n");
+  put("import three;\n");
+}
+
+
+void asy_writer::perspective(Vector3d const &v) {
+  put("currentprojection = perspective").put(v).put(";\n");
+}
+
+
+void asy_writer::sphere(
+    Vector3d const &v, double s, string const &c, double op) {
+  put("draw(shift").put(v).put("*scale3(").put(s).put(")");
+  put("*unitsphere,").put(c).put("+opacity(").put(op).put("));\n");
+}
+
+
+void asy_writer::label(int i, Vector3d const &v, string const &c, bool bb) {
+  put("label(\"").put(i).put("\",").put(v).put(",").put(c).put(",");
+  put(bb ? "Billboard" : "Embedded").put(");\n");
+}
+
+
+void asy_writer::arrow(Vector3d const &b, Vector3d const &e) {
+  put("draw(").put(b).put("--").put(e).put(",");
+  put("arrow=Arrow3(size=10.0),");
+  put("p=lightcyan+linewidth(2.0),");
+  put("light=currentlight);\n");
+}
+
+
+void write_asy(string const &path,
+    Eigen::Matrix3Xd const &pos,
+    std::vector<edge> const &edges) {
+  asy_writer w(path);
+  w.header();
+  w.perspective({0, -2.0 * pos.colwise().norm().maxCoeff(), 0});
+  unsigned e= 0; // Offset of next edge.
+  for(int i= 0; i < pos.cols(); ++i) {
+    Vector3d const ip= pos.col(i); // Position of Node i.
+    w.sphere(ip);
+    w.label(i, ip);
+    for(; e < edges.size() && edges[e][0] == i; ++e) {
+      Vector3d const jp= pos.col(edges[e][1]); // Position of head.
+      // ij_q is one-quarter of displacement from Node i toward head.
+      Vector3d const ij_q= (jp - ip).normalized() * 0.25;
+      w.arrow(ip + ij_q, jp - ij_q);
+    }
+  }
+  w.close();
+}
+
+
+} // namespace modgraph
+
+// EOF
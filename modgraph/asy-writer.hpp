@@ -0,0 +1,132 @@
+/// @file       asy-writer.hpp
+/// @brief      Declaration of modgraph::asy_writer and
+///             modgraph::write_asy().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include "ply-writer.hpp" // edge
+#include <eigen3/Eigen/Core> // Vector3d
+#include <fstream> // ofstream
+#include <string> // string
+#include <vector> // vector
+
+namespace modgraph {
+
+
+/// Streaming writer of commands to asy-file.
+/// - Every command is formatted directly into one large buffer, which is
+///   reused and is written to file in big blocks, so that no temporary
+///   string is made for any primitive.
+/// - Floating-point number is formatted like default output by ostream
+///   (six significant digits, as with printf's "%g").
+class asy_writer {
+  static constexpr unsigned BLOCK= 1 << 20; ///< Size of block written.
+
+  /// Room left in buffer for longest single item (number or literal text);
+  /// when less than this be left, buffer is flushed.
+  static constexpr unsigned SLACK= 64;
+
+  std::ofstream ofs_; ///< Output-file.
+  std::vector<char> buf_; ///< Buffer of text not yet written.
+  unsigned len_= 0; ///< Number of characters in buffer.
+
+  /// Write buffer to file, and empty buffer.
+  void flush();
+
+  /// Make room for at least SLACK characters.
+  void reserve() {
+    if(len_ + SLACK > buf_.size()) flush();
+  }
+
+  /// Append literal text.
+  /// @param s  Text.
+  /// @return  Reference to this writer.
+  asy_writer &put(std::string const &s);
+
+  /// Append literal text.
+  /// @param s  Null-terminated text.
+  /// @return  Reference to this writer.
+  asy_writer &put(char const *s);
+
+  /// Append number formatted like "%g".
+  /// @param v  Number.
+  /// @return  Reference to this writer.
+  asy_writer &put(double v);
+
+  /// Append integer.
+  /// @param i  Integer.
+  /// @return  Reference to this writer.
+  asy_writer &put(int i);
+
+  /// Append position like "(x,y,z)".
+  /// @param v  Components of position.
+  /// @return  Reference to this writer.
+  asy_writer &put(Eigen::Vector3d const &v);
+
+public:
+  /// Open file for writing.
+  /// @param path  Path of file.
+  asy_writer(std::string const &path);
+
+  /// Flush remaining text, and close file, unless close() were called.
+  /// - Failure to write is not reported; so caller should call close().
+  ~asy_writer();
+
+  /// Flush remaining text, and close file.
+  /// - Exception of type `char const*` is thrown if any write failed.
+  void close();
+
+  /// Write basic header.
+  /// @param ofmt  Format of output-file (when asy be not invoked with '-V').
+  /// @param prc  True if PRC-vector-graphics should be embedded in PDF.
+  /// @param unit_cm  Unit of distance (in cm).
+  void header(std::string const &ofmt= "pdf",
+      std::string const &prc= "false",
+      double unit_cm= 1.0);
+
+  /// Write perspective for current projection.
+  /// @param v  Camera's location.
+  void perspective(Eigen::Vector3d const &v);
+
+  /// Write draw-command for sphere.
+  /// @param v  Reference to position of sphere.
+  /// @param s  Scale of sphere.
+  /// @param c  Color of sphere.
+  /// @param op  Opacity of sphere.
+  void sphere(Eigen::Vector3d const &v,
+      double s= 0.25,
+      std::string const &c= "lightmagenta",
+      double op= 0.5);
+
+  /// Write label-command for numeric label.
+  /// @param i  Number for numeric label.
+  /// @param v  Reference to position of label.
+  /// @param c  Color of label.
+  /// @param bb  True for billboard-label (camera-facing); false for embedded.
+  void label(int i,
+      Eigen::Vector3d const &v,
+      std::string const &c= "black",
+      bool bb= true);
+
+  /// Write arrow-drawing-command.
+  /// @param b  Beginning coordinates for arrow.
+  /// @param e  Ending coordinates for arrow.
+  void arrow(Eigen::Vector3d const &b, Eigen::Vector3d const &e);
+};
+
+
+/// Write scene as text-file for asymptote.
+/// - Every node is drawn as labeled sphere, and every directed edge as arrow
+///   between spheres.
+/// @param path  Path of file.
+/// @param pos  3xN matrix for position of each of N nodes.
+/// @param edges  Directed edges, in increasing order of tail.
+void write_asy(std::string const &path,
+    Eigen::Matrix3Xd const &pos,
+    std::vector<edge> const &edges);
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,317 @@
+/// @file       bench.cpp
+/// @brief      Benchmarks of evaluation, of output, and of minimization.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+///
+/// Each benchmark prints one record, as CSV (default) or as JSON, so that
+/// results can be compared across revisions.
+/// - eval_both, eval_potential, and eval_forces time
+///   minimizer::net_force_and_pot() for each quantities.
+/// - repel_row and repel_row_float time exact pairwise kernel alone over
+///   every row, in double and in single precision.
+/// - hess_row times product of Hessian of repulsion with direction over
+///   every row.
+/// - write_asy and write_ply time output of scene.
+/// - minimize times whole of layout, from initial positions to convergence.
+
+#include "graph.hpp" // graph, squares
+#include "gsl-funcs.hpp" // known_algorithm
+#include "repulsion.hpp" // hess_row, repel_row, repel_isa
+#include <chrono> // steady_clock
+#include <cstdio> // printf, remove
+#include <cstdlib> // atof, atoi
+#include <iostream> // cerr, endl
+#include <sstream> // istringstream
+#include <string> // string, to_string
+#include <unistd.h> // getopt(), optarg, optind
+#include <vector> // vector
+
+using namespace modgraph;
+using Eigen::Matrix3Xd;
+using std::string;
+using std::vector;
+
+
+static char const usage[]=
+    "usage: modgraph-bench [-f csv|json] [-n sizes] [-e sizes] [-T secs]\n"
+    "                      [-a theta] [-t threads] [-m algorithm]\n"
+    "                      [-F double|float|mixed]\n"
+    "  sizes: comma-separated list of numbers of nodes\n"
+    "  -n: sizes for evaluation and output (default 10,...,50000)\n"
+    "  -e: sizes for end-to-end minimization (default 10,33,100)\n"
+    "  -T: least time spent on each timed benchmark (default 0.5)";
+
+
+/// Result of one benchmark.
+struct record {
+  string name; ///< Name of benchmark.
+  int n; ///< Number of nodes.
+  int reps; ///< Number of repetitions timed.
+  double seconds; ///< Total time of every repetition.
+  double rate; ///< Units per second.
+  char const *unit; ///< Unit of rate, like "eval" or "pair".
+  int iterations= 0; ///< Iterations of minimizer (minimize only).
+  int evaluations= 0; ///< Evaluations by minimizer (minimize only).
+  bool converged= false; ///< True if minimization converged.
+  double potential= 0.0; ///< Final potential (minimize only).
+};
+
+
+/// Sink for records, in chosen format.
+class report {
+  bool json_; ///< True for JSON; false for CSV.
+  options const &opts_; ///< Options common to every benchmark.
+  int count_= 0; ///< Number of records printed.
+
+public:
+  /// Print header (CSV) or opening bracket (JSON).
+  /// @param json  True for JSON; false for CSV.
+  /// @param o  Options common to every benchmark.
+  report(bool json, options const &o): json_(json), opts_(o) {
+    if(json_) {
+      std::printf("[\n");
+    } else {
+      std::printf("name,n,isa,threads,theta,reps,seconds,rate,unit,"
+                  "iterations,evaluations,converged,potential\n");
+    }
+  }
+
+  /// Print closing bracket (JSON).
+  ~report() {
+    if(json_) std::printf("\n]\n");
+  }
+
+  /// Print one record.
+  /// @param r  Record.
+  void print(record const &r) {
+    char const *fmt= json_ ? "%s{\"name\":\"%s\",\"n\":%d,\"isa\":\"%s\","
+                             "\"threads\":%d,\"theta\":%g,\"reps\":%d,"
+                             "\"seconds\":%g,\"rate\":%g,\"unit\":\"%s\","
+                             "\"iterations\":%d,\"evaluations\":%d,"
+                             "\"converged\":%s,\"potential\":%.10g}"
+                           : "%s%s,%d,%s,%d,%g,%d,%g,%g,%s,%d,%d,%s,%.10g\n";
+    char const *sep= (json_ && count_ > 0) ? ",\n" : "";
+    std::printf(fmt,
+        sep,
+        r.name.c_str(),
+        r.n,
+        repel_isa(),
+        opts_.threads,
+        opts_.theta,
+        r.reps,
+        r.seconds,
+        r.rate,
+        r.unit,
+        r.iterations,
+        r.evaluations,
+        r.converged ? "true" : "false",
+        r.potential);
+    std::fflush(stdout);
+    ++count_;
+  }
+};
+
+
+/// Seconds elapsed since `t0`.
+/// @param t0  Start.
+/// @return  Seconds.
+static double since(std::chrono::steady_clock::time_point t0) {
+  std::chrono::duration<double> const d= std::chrono::steady_clock::now() - t0;
+  return d.count();
+}
+
+
+/// Call `f` repeatedly, at least once, until `secs` have elapsed.
+/// @param f  Function to time.
+/// @param secs  Least time to spend.
+/// @param name  Name of benchmark.
+/// @param n  Number of nodes.
+/// @param per  Units of work per call.
+/// @param unit  Name of unit of work.
+/// @return  Record with number of repetitions, time, and rate.
+template<typename F>
+static record time_reps(F const &f,
+    double secs,
+    string const &name,
+    int n,
+    double per,
+    char const *unit) {
+  auto const t0= std::chrono::steady_clock::now();
+  int reps= 0;
+  double s;
+  do {
+    f();
+    ++reps;
+  } while((s= since(t0)) < secs);
+  record r;
+  r.name= name;
+  r.n= n;
+  r.reps= reps;
+  r.seconds= s;
+  r.rate= reps * per / s;
+  r.unit= unit;
+  return r;
+}
+
+
+/// Parse comma-separated list of sizes, each exceeding 1.
+/// @param s  Text to parse.
+/// @param v  On successful return, sizes.
+/// @return  False if `s` be malformed.
+static bool parse_sizes(char const *s, vector<int> &v) {
+  std::istringstream iss(s);
+  string item;
+  v.clear();
+  while(std::getline(iss, item, ',')) {
+    std::istringstream is(item);
+    int n;
+    if(!(is >> n) || n < 2 || !(is >> std::ws).eof()) return false;
+    v.push_back(n);
+  }
+  return !v.empty();
+}
+
+
+/// Time evaluation, kernel, and output for `n` nodes.
+/// @param n  Number of nodes.
+/// @param o  Options.
+/// @param secs  Least time spent on each benchmark.
+/// @param out  Sink for records.
+static void bench_kernels(int n, options const &o, double secs, report &out) {
+  squares const g(n); // Tables only; m is sole minimizer.
+  minimizer m(g, o);
+  Matrix3Xd grad(3, n);
+  Matrix3Xd const &pos= m.positions();
+  struct {
+    char const *name;
+    quantities q;
+  } const modes[]= {{"eval_both", BOTH},
+      {"eval_potential", POTENTIAL},
+      {"eval_forces", FORCES}};
+  for(auto const &e: modes) {
+    out.print(time_reps([&] { m.net_force_and_pot(pos, grad.data(), e.q); },
+        secs,
+        e.name,
+        n,
+        1.0,
+        "eval"));
+  }
+  soa const p= pos.transpose();
+  soa f(n, 3);
+  double u= 0.0;
+  out.print(time_reps(
+      [&] {
+        f.setZero();
+        for(int i= 0; i < n; ++i) u+= repel_row(p, i, f);
+      },
+      secs,
+      "repel_row",
+      n,
+      0.5 * n * (n - 1.0),
+      "pair"));
+  soa_f const pf= p.cast<float>();
+  soa_f ff(n, 3);
+  out.print(time_reps(
+      [&] {
+        ff.setZero();
+        for(int i= 0; i < n; ++i) u+= repel_row(pf, i, ff);
+      },
+      secs,
+      "repel_row_float",
+      n,
+      0.5 * n * (n - 1.0),
+      "pair"));
+  soa const v= soa::Ones(n, 3);
+  out.print(time_reps(
+      [&] {
+        f.setZero();
+        for(int i= 0; i < n; ++i) hess_row(p, v, i, f);
+      },
+      secs,
+      "hess_row",
+      n,
+      0.5 * n * (n - 1.0),
+      "pair"));
+  string const stem= std::to_string(n);
+  auto const asy= [&] { g.write(pos, stem, "asy"); };
+  out.print(time_reps(asy, secs, "write_asy", n, 1.0, "file"));
+  std::remove((stem + ".asy").c_str());
+  auto const ply= [&] { g.write(pos, stem, "ply"); };
+  out.print(time_reps(ply, secs, "write_ply", n, 1.0, "file"));
+  std::remove((stem + ".ply").c_str());
+  if(u == 0.0) std::cerr << "bench: unexpected zero potential" << std::endl;
+}
+
+
+/// Time whole of minimization for `n` nodes.
+/// @param n  Number of nodes.
+/// @param o  Options.
+/// @param out  Sink for records.
+static void bench_minimize(int n, options const &o, report &out) {
+  graph g(n, o);
+  auto const t0= std::chrono::steady_clock::now();
+  g.layout();
+  double const s= since(t0);
+  minimizer const &m= g.layout_minimizer();
+  record r;
+  r.name= "minimize";
+  r.n= n;
+  r.reps= 1;
+  r.seconds= s;
+  r.rate= m.evaluations() / s;
+  r.unit= "eval";
+  r.iterations= m.iterations();
+  r.evaluations= m.evaluations();
+  r.converged= m.converged();
+  r.potential= m.potential();
+  out.print(r);
+}
+
+
+int main(int argc, char **argv) {
+  options opts;
+  opts.progress_format= "none";
+  bool json= false;
+  double secs= 0.5;
+  vector<int> sizes{10, 100, 1000, 10000, 50000};
+  vector<int> e2e{10, 33, 100};
+  int c;
+  while((c= getopt(argc, argv, "f:n:e:T:a:t:m:F:")) != -1) {
+    bool ok= true;
+    switch(c) {
+      case 'f':
+        json= (string(optarg) == "json");
+        ok= json || string(optarg) == "csv";
+        break;
+      case 'n': ok= parse_sizes(optarg, sizes); break;
+      case 'e': ok= parse_sizes(optarg, e2e); break;
+      case 'T': ok= (secs= std::atof(optarg)) >= 0.0; break;
+      case 'a': ok= (opts.theta= std::atof(optarg)) >= 0.0; break;
+      case 't': ok= (opts.threads= std::atoi(optarg)) > 0; break;
+      case 'm':
+        opts.algorithm= optarg;
+        ok= known_algorithm(opts.algorithm);
+        break;
+      case 'F':
+        opts.precision= optarg;
+        ok= minimizer::known_precision(opts.precision);
+        break;
+      default: std::cerr << usage << std::endl; return 1;
+    }
+    if(!ok) {
+      std::cerr << "illegal argument '" << optarg << "' for -" << char(c)
+                << std::endl;
+      return 1;
+    }
+  }
+  try {
+    report out(json, opts);
+    for(int n: sizes) bench_kernels(n, opts, secs, out);
+    for(int n: e2e) bench_minimize(n, opts, out);
+  } catch(char const *e) {
+    std::cerr << "bench: " << e << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+// EOF
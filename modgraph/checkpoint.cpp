@@ -0,0 +1,67 @@
+/// @file       checkpoint.cpp
+/// @brief      Definition of modgraph::checkpoint_dir.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "checkpoint.hpp"
+#include "position-file.hpp" // read_positions, write_positions
+#include <cstdint> // int32_t
+#include <filesystem> // path, remove
+
+namespace fs= std::filesystem;
+using std::string;
+
+
+namespace modgraph {
+
+
+/// First bytes of every checkpoint.
+constexpr char CKPT_MAGIC[8]= {'m', 'o', 'd', 'g', 'c', 'k', 'p', '1'};
+
+
+/// Header at start of every checkpoint, followed by 3xN doubles.
+struct ckpt_header {
+  char magic[8]; ///< Copy of CKPT_MAGIC.
+  layout_key key; ///< Key for layout.
+  int32_t stage; ///< Stage of minimization.
+  int32_t iterations; ///< Iterations so far.
+  int32_t nodes; ///< Number N of nodes.
+};
+
+
+string checkpoint_dir::path(layout_key const &k) const {
+  return (fs::path(dir_) / (k.stem() + ".ckpt")).string();
+}
+
+
+bool checkpoint_dir::load(layout_key const &k, checkpoint &c) const {
+  ckpt_header h;
+  Eigen::Matrix3Xd p;
+  if(!read_positions(path(k), CKPT_MAGIC, h, &p) || !(h.key == k)) {
+    return false;
+  }
+  c.key= h.key;
+  c.stage= h.stage;
+  c.iterations= h.iterations;
+  c.positions= std::move(p);
+  return true;
+}
+
+
+void checkpoint_dir::store(checkpoint const &c) const {
+  ckpt_header h=
+      new_header<ckpt_header>(CKPT_MAGIC, c.key, c.positions.cols());
+  h.stage= c.stage;
+  h.iterations= c.iterations;
+  write_positions(path(c.key), &h, sizeof(h), c.positions, "checkpoint");
+}
+
+
+void checkpoint_dir::remove(layout_key const &k) const {
+  std::error_code ec;
+  fs::remove(path(k), ec);
+}
+
+
+} // namespace modgraph
+
+// EOF
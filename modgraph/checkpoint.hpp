@@ -0,0 +1,69 @@
+/// @file       checkpoint.hpp
+/// @brief      Declaration of modgraph::checkpoint and
+///             modgraph::checkpoint_dir.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include "layout-cache.hpp" // layout_key
+#include <eigen3/Eigen/Core> // Matrix3Xd
+#include <string> // string
+
+namespace modgraph {
+
+
+/// State of minimization saved periodically, so that layout pre-empted (or
+/// stopped by deadline) can resume where it left off.
+/// - GSL offers no way to save internal state of its method (like BFGS's
+///   estimate of Hessian); so resumed method starts afresh from saved
+///   positions, as after restart in double precision.
+struct checkpoint {
+  layout_key key; ///< Modulus and parameters of potential.
+  int stage= 0; ///< 0 for mirror-constrained stage, 1 for main stage.
+  int iterations= 0; ///< Iterations over every stage so far.
+  Eigen::Matrix3Xd positions; ///< Position of every node.
+};
+
+
+/// Directory of checkpoints, one compact binary file per modulus and
+/// parameters of potential.
+/// - Each file is written atomically (via rename), so that pre-emption
+///   while writing leaves previous checkpoint intact.
+/// - Failure to read or to write checkpoint is reported but is never fatal.
+class checkpoint_dir {
+  std::string dir_; ///< Directory holding checkpoints.
+
+  /// Name of file for key.
+  /// @param k  Key for layout.
+  /// @return  Path of file, like "dir/33-0123456789abcdef.ckpt", as by
+  ///          layout_key::stem().
+  std::string path(layout_key const &k) const;
+
+public:
+  /// Initialize directory.
+  /// @param dir  Directory, which is created if necessary on first store().
+  checkpoint_dir(std::string const &dir): dir_(dir) {}
+
+  /// Load checkpoint for key.
+  /// - Checkpoint for different parameters (whose file's hash collide) is
+  ///   ignored.
+  /// @param k  Key for layout.
+  /// @param c  On successful return, checkpoint.
+  /// @return  True if checkpoint were found.
+  bool load(layout_key const &k, checkpoint &c) const;
+
+  /// Store checkpoint, replacing previous one for same key.
+  /// - File is written by write_positions(), whose temporary file concurrent
+  ///   layouts never share.
+  /// @param c  Checkpoint.
+  void store(checkpoint const &c) const;
+
+  /// Remove checkpoint for key, once layout be complete.
+  /// @param k  Key for layout.
+  void remove(layout_key const &k) const;
+};
+
+
+} // namespace modgraph
+
+// EOF
@@ -1,12 +1,14 @@
 
 /// @file       graph.cpp
-/// @brief      Definition of modgraph::graph.
+/// @brief      Definition of modgraph::squares and modgraph::graph.
 /// @copyright  2022 Thomas E. Vaughan, all rights reserved.
 
 #include "graph.hpp"
-#include "asy-adapter.hpp" // asy_adapter and descendants
-#include <cstdlib> // rand(), RAND_MAX
-#include <fstream> // ofstream
+#include "asy-writer.hpp" // write_asy
+#include "incremental.hpp" // changed_nodes, incremental_start
+#include "ply-writer.hpp" // write_ply
+#include <cstdint> // int64_t
+#include <string> // string, to_string
 
 namespace modgraph {
 
@@ -16,38 +18,175 @@ using Eigen::MatrixXd;
 
 /// File-name for modulus `m`.
 /// @param m  Modulus.
-/// @return  Name of asymptote-file.
-auto filename(int m) {
-  std::ostringstream oss;
-  oss << m << ".asy";
-  return oss.str();
+/// @param ext  Extension, like ".asy" or ".ply".
+/// @return  Name of file for scene.
+std::string filename(int m, char const *ext= ".asy") {
+  return std::to_string(m) + ext;
 }
 
 
 void graph::write_asy() const {
-  std::ofstream ofs(filename(modulus));
-  ofs << header() << perspective({0, -2.0 * biggest_radius(), 0});
+  write_asy(minimizer_.positions(), filename(modulus));
+}
+
+
+void graph::write_asy(
+    Eigen::Matrix3Xd const &pos, std::string const &path) const {
+  modgraph::write_asy(path, pos, edges());
+}
+
+
+void graph::write_ply() const {
+  write_ply(minimizer_.positions(), filename(modulus, ".ply"));
+}
+
+
+void graph::write_ply(
+    Eigen::Matrix3Xd const &pos, std::string const &path) const {
+  modgraph::write_ply(path, pos, edges());
+}
+
+
+std::vector<edge> squares::edges() const {
+  std::vector<edge> r; // Return-value.
+  r.reserve(modulus);
   for(int i= 0; i < modulus; ++i) {
-    auto const &ip= minimizer_.positions().col(i); // Position of Node i.
-    ofs << sphere(ip) << label(i, ip);
     int const j= next(i);
-    if(i != j) {
-      auto const &jp= minimizer_.positions().col(j); // Position of Node j.
-      // ij_q is one-quarter of displacement from Node i toward Node j.
-      auto const ij_q= (jp - ip).normalized() * 0.25;
-      ofs << arrow(ip + ij_q, jp - ij_q);
-    }
+    if(i != j) r.push_back({i, j});
   }
+  return r;
 }
 
 
-graph::graph(int m): modulus(m), minimizer_(*this) {
+void graph::layout_from(
+    springs::matrix const &prev, Eigen::Matrix3Xd const &pos) {
+  minimizer_.warm_start(incremental_start(*this, pos, minimizer_.seed()),
+      changed_nodes(prev, minimizer_.spring_constants()));
+  minimizer_.go();
+}
+
+
+void graph::write() const {
+  if(format_ == "ply") {
+    write_ply(); // Write binary scene for modern viewer.
+  } else {
+    write_asy(); // Write text-file for asymptote.
+  }
+}
+
+
+void squares::write(Eigen::Matrix3Xd const &pos,
+    std::string const &stem,
+    std::string const &format) const {
+  if(format == "ply") {
+    modgraph::write_ply(stem + ".ply", pos, edges());
+  } else {
+    modgraph::write_asy(stem + ".asy", pos, edges());
+  }
+}
+
+
+/// Successor of every node under squaring modulo `m`.
+/// - Square is computed in 64 bits, so that no modulus representable as int
+///   can overflow.
+/// @param m  Modulus.
+/// @return  Table whose element `i` is (i * i) % m.
+std::vector<int> square_table(int m) {
   if(m < 0) throw "illegal modulus";
-  minimizer_.go(); // Find final positions.
-  write_asy(); // Write text-file for asymptote.
+  std::vector<int> r(m); // Return-value.
+  for(int i= 0; i < m; ++i) {
+    r[i]= int(std::int64_t(i) * i % m);
+  }
+  return r;
+}
+
+
+/// Offset of first predecessor of each node in compressed inverse
+/// adjacency.
+/// @param next  Successor of every node.
+/// @return  For each Node `i`, number of nodes `j` whose successor be less
+///          than `i`; last element is N.
+std::vector<int> pred_offsets(std::vector<int> const &next) {
+  std::vector<int> r(next.size() + 1, 0); // Return-value.
+  for(int j: next) ++r[j + 1];
+  for(unsigned i= 0; i < next.size(); ++i) r[i + 1]+= r[i];
+  return r;
+}
+
+
+/// Predecessors of every node, grouped by node and increasing within group.
+/// @param next  Successor of every node.
+/// @param begin  Return-value of pred_offsets(next).
+/// @return  Compressed inverse adjacency.
+std::vector<int> pred_nodes(
+    std::vector<int> const &next, std::vector<int> const &begin) {
+  std::vector<int> r(next.size()); // Return-value.
+  std::vector<int> fill(begin.begin(), begin.end() - 1);
+  for(unsigned j= 0; j < next.size(); ++j) r[fill[next[j]]++]= j;
+  return r;
+}
+
+
+/// Calculate factors of `m` by trial division up to square root of `m`.
+/// - Include 0, which represents `m` in modular arithmetic.
+/// - Do not include 1 as a factor.
+/// @param m  Positive integer whose factors are calculated.
+/// @return  List of nontrivial factors, in increasing order.
+std::vector<int> calculate_factors(int m) {
+  std::vector<int> f({0}); // Return-value.
+  std::vector<int> big; // Cofactors, in decreasing order.
+  for(int i= 2; i <= m / i; ++i) {
+    if(m % i) continue;
+    f.push_back(i);
+    if(m / i != i) big.push_back(m / i);
+  }
+  f.insert(f.end(), big.rbegin(), big.rend());
+  return f;
+}
+
+
+/// Weight of every residue modulo `m`.
+/// @param m  Modulus.
+/// @param factors  Return-value of calculate_factors(m).
+/// @return  Dense table described at graph::weight().
+std::vector<double> residue_weights(int m, std::vector<int> const &factors) {
+  std::vector<double> w(m, 0.0); // Return-value.
+  if(m > 0) w[0]= 1.0;
+  for(int n: factors) {
+    if(n == 0) continue;
+    w[n]+= double(n) / m;
+    w[m - n]+= double(n) / m;
+  }
+  return w;
+}
+
+
+/// Every residue of nonzero weight.
+/// @param w  Return-value of residue_weights().
+/// @return  Residues, in increasing order.
+std::vector<int> nonzero(std::vector<double> const &w) {
+  std::vector<int> r; // Return-value.
+  for(unsigned i= 0; i < w.size(); ++i) {
+    if(w[i] != 0.0) r.push_back(i);
+  }
+  return r;
 }
 
 
+squares::squares(int m):
+    modulus(m),
+    next_(square_table(m)),
+    pred_begin_(pred_offsets(next_)),
+    pred_(pred_nodes(next_, pred_begin_)),
+    factors_(calculate_factors(m)),
+    weight_(residue_weights(m, factors_)),
+    weighted_(nonzero(weight_)) {}
+
+
+graph::graph(int m, options const &o):
+    squares(m), format_(o.format), minimizer_(*this, o) {}
+
+
 } // namespace modgraph
 
 // EOF
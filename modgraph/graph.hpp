@@ -1,40 +1,178 @@
 
 /// @file       graph.hpp
-/// @brief      Declaration of modgraph::graph.
+/// @brief      Declaration of modgraph::squares and modgraph::graph.
 /// @copyright  2022 Thomas E. Vaughan, all rights reserved.
 
 #pragma once
 
 #include "minimizer.hpp" // minimizer
+#include "ply-writer.hpp" // edge
+#include "springs.hpp" // springs
+#include <string> // string
+#include <vector> // vector
 
 namespace modgraph {
 
 
-/// Three-dimenional position for each node in directed graph of squares under
-/// modular arithmetic.
-class graph {
-  /// Write text-file for asymptote.
-  void write_asy() const;
+/// Contiguous range of offsets of nodes, for range-based for-loop.
+struct node_range {
+  int const *first; ///< Pointer to first offset.
+  int const *last; ///< Pointer past last offset.
 
-  /// Largest distance of any node from origin.
-  /// @return  Largest distance of any node from origin.
-  double biggest_radius() const {
-    return minimizer_.positions().colwise().norm().maxCoeff();
-  }
+  int const *begin() const { return first; } ///< Pointer to first offset.
+  int const *end() const { return last; } ///< Pointer past last offset.
+  int size() const { return int(last - first); } ///< Number of offsets.
+};
 
+
+/// Tables of directed graph of squares under modular arithmetic, from which
+/// springs are built.
+/// - Tables are built without any position, thread, or buffer; so springs of
+///   other modulus (as for incremental layout) cost only these.
+class squares {
 public:
-  /// Construct graphs for modulus m.
+  /// Build tables for modulus m.
   /// @param m  Modulus of graphs.
-  graph(int m);
+  squares(int m);
 
   int const modulus; ///< Modulus for graph of squares.
 
   /// Number of node pointed to by Node `i`.
+  /// - Successor of every node is computed once, with 64-bit arithmetic so
+  ///   that no square overflows, when graph is constructed.
   /// @param i  Number of node.
   /// @return  Number of node pointed to by Node `i`.
-  int next(int i) const { return (i * i) % modulus; }
+  int next(int i) const { return next_[i]; }
+
+  /// Every directed edge from node to its successor, omitting loop at fixed
+  /// point of squaring.
+  /// @return  Edges in increasing order of tail.
+  std::vector<edge> edges() const;
+
+  /// Write scene for given positions.
+  /// @param pos  3xN matrix for position of each of N nodes.
+  /// @param stem  Name of file without extension, like "33".
+  /// @param format  "asy" for text-file for asymptote, or "ply" for binary
+  ///                PLY-file.
+  void write(Eigen::Matrix3Xd const &pos,
+      std::string const &stem,
+      std::string const &format) const;
+
+  /// Successor of every node, indexed by node.
+  /// @return  Reference to table of successors.
+  std::vector<int> const &successors() const { return next_; }
+
+  /// Every node that points to Node `i`, in increasing order.
+  /// @param i  Number of node.
+  /// @return  Range of nodes `j` for which next(j) be `i`.
+  node_range predecessors(int i) const {
+    int const *p= pred_.data();
+    return {p + pred_begin_[i], p + pred_begin_[i + 1]};
+  }
+
+  /// Nontrivial factors of modulus, in increasing order.
+  /// - 0, which represents modulus in modular arithmetic, is first; 1 is
+  ///   excluded.
+  /// @return  Reference to list of factors.
+  std::vector<int> const &factors() const { return factors_; }
+
+  /// Relative strength of attraction associated with residue `r`, either as
+  /// `(i + j) % m` for pair of nodes, or as node itself.
+  /// - Weight is 1 for zero, f / m for factor `f` and for `m - f`, summed if
+  ///   `r` be both, and 0 for every other residue.
+  /// - Table is dense, so that lookup costs one load.
+  /// @param r  Residue in [0, m).
+  /// @return  Weight of residue.
+  double weight(int r) const { return weight_[r]; }
+
+  /// Every residue of nonzero weight(), in increasing order.
+  /// @return  Reference to list of residues.
+  std::vector<int> const &weighted() const { return weighted_; }
+
+private:
+  /// Successor of every node.
+  std::vector<int> const next_;
+
+  /// For each Node `i`, offset in pred_ of first predecessor of `i`; last
+  /// element is N.
+  std::vector<int> const pred_begin_;
+
+  /// Predecessors of every node, grouped by node (inverse adjacency in
+  /// compressed-row form).
+  std::vector<int> const pred_;
+
+  std::vector<int> const factors_; ///< Nontrivial factors of modulus.
+  std::vector<double> const weight_; ///< Weight of each residue.
+  std::vector<int> const weighted_; ///< Residues of nonzero weight.
+};
+
+
+/// Three-dimenional position for each node in directed graph of squares under
+/// modular arithmetic.
+/// - Tables of squares precede minimizer_, whose springs are built from them.
+class graph: public squares {
+public:
+  /// Construct graphs for modulus m.
+  /// - Construction neither positions nodes nor writes any file; call
+  ///   layout() and then write().
+  /// @param m  Modulus of graphs.
+  /// @param o  Run-time options governing layout.
+  graph(int m, options const &o= options());
+
+  /// Find final positions of nodes.
+  void layout() { minimizer_.go(); }
+
+  /// Find final positions of nodes again, from random positions drawn from
+  /// seed, while every table, list of springs, and workspace is kept.
+  /// @param seed  Seed of initial positions, as for options::seed.
+  void relayout(unsigned seed) {
+    minimizer_.restart(seed);
+    minimizer_.go();
+  }
+
+  /// Find final positions of nodes incrementally from earlier layout
+  /// (typically of nearby modulus or strengths), as described in
+  /// incremental.hpp.
+  /// @param prev  Spring-constants of earlier layout.
+  /// @param pos  3xM matrix for position of each of M nodes of earlier
+  ///             layout.
+  void layout_from(
+      springs::matrix const &prev, Eigen::Matrix3Xd const &pos);
+
+  /// Write scene in format chosen by options.
+  void write() const;
+
+  /// Write scene for given positions in format chosen by options.
+  /// - Layout of each variant in sweep is written by this.
+  /// @param pos  3xN matrix for position of each of N nodes.
+  /// @param stem  Name of file without extension, like "33".
+  void write(Eigen::Matrix3Xd const &pos, std::string const &stem) const {
+    squares::write(pos, stem, format_);
+  }
+
+  /// Write text-file for asymptote.
+  void write_asy() const;
+
+  /// Write text-file for asymptote.
+  /// @param pos  3xN matrix for position of each of N nodes.
+  /// @param path  Name of file.
+  void write_asy(Eigen::Matrix3Xd const &pos, std::string const &path) const;
+
+  /// Write binary PLY-file of vertices and directed edges.
+  void write_ply() const;
+
+  /// Write binary PLY-file of vertices and directed edges.
+  /// @param pos  3xN matrix for position of each of N nodes.
+  /// @param path  Name of file.
+  void write_ply(Eigen::Matrix3Xd const &pos, std::string const &path) const;
+
+  /// Facility for force-minimization via GSL.
+  /// @return  Reference to minimizer, for statistics of layout.
+  minimizer const &layout_minimizer() const { return minimizer_; }
 
 private:
+  std::string const format_; ///< Format of scene: "asy" or "ply".
+
   minimizer minimizer_; ///< Facility for force-minimization via GSL.
 };
 
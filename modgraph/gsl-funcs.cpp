@@ -5,11 +5,11 @@
 
 #include "gsl-funcs.hpp"
 #include "minimizer.hpp" // minimizer
+#include <gsl/gsl_blas.h> // gsl_blas_dnrm2
 #include <iostream> // cerr, endl
 
 using Eigen::Matrix3Xd;
 using std::cerr;
-using std::cout;
 using std::endl;
 
 
@@ -18,42 +18,76 @@ using std::endl;
 /// - `pos_map` is used by driver to copy positions out of GSL when done.
 /// @param x  Pointer to gsl_vector that contains coordinates for N nodes.
 /// @return   Map that presents data as 3xN-matrix.
-Eigen::Map<Eigen::MatrixXd const> pos_map(gsl_vector const *x) {
+Eigen::Map<Matrix3Xd const> pos_map(gsl_vector const *x) {
   if(x->size != x->size / 3 * 3) {
     std::cerr << "pos_Map: ERROR: size not multiple of three" << std::endl;
     throw "invalid size";
   }
-  return Eigen::Map<Eigen::MatrixXd const>(x->data, 3, x->size / 3);
+  if(x->stride != 1) throw "non-contiguous gsl_vector";
+  return Eigen::Map<Matrix3Xd const>(x->data, 3, x->size / 3);
+}
+
+
+/// Storage of gsl_vector that receives gradient.
+/// - Gradient is written directly into GSL's storage, without copy.
+/// @param g  Pointer to gsl_vector for gradient.
+/// @param x  Pointer to gsl_vector of positions, of same size.
+/// @return  Pointer to first component of gradient.
+static double *grad_data(gsl_vector *g, gsl_vector const *x) {
+  if(g->size != x->size) throw "gradient and positions differ in size";
+  if(g->stride != 1) throw "non-contiguous gsl_vector";
+  return g->data;
 }
 
 
 extern "C" {
 double f(gsl_vector const *x, void *pmin) {
   if(!x || !pmin) throw "null pointer";
-  auto const positions= pos_map(x);
   auto &min= *(modgraph::minimizer *)pmin;
-  min.net_force_and_pot(positions);
+  // Line-search needs only potential; skip every force.
+  min.net_force_and_pot(pos_map(x), nullptr, modgraph::POTENTIAL);
   return min.potential();
 }
 
 
 void fdf(gsl_vector const *x, void *pmin, double *pot, gsl_vector *grd) {
-  if(!pot || !grd) throw "null pointer";
-  *pot= f(x, pmin);
+  if(!x || !pmin || !pot || !grd) throw "null pointer";
   auto &min= *(modgraph::minimizer *)pmin;
-  for(unsigned i= 0; i < grd->size; ++i) {
-    // Force is *negative* gradient of potential.
-    gsl_vector_set(grd, i, -min.net_force_component(i));
-  }
+  min.net_force_and_pot(pos_map(x), grad_data(grd, x), modgraph::BOTH);
+  *pot= min.potential();
 }
 
 
-// Code is not set up to calculate the gradient independently from potential.
-// That could be future optimization.  At present, df() just calls fdf() and
-// ignores potential.
 void df(gsl_vector const *x, void *pmin, gsl_vector *grd) {
-  double pot; // Ignored result.
-  fdf(x, pmin, &pot, grd);
+  if(!x || !pmin || !grd) throw "null pointer";
+  auto &min= *(modgraph::minimizer *)pmin;
+  // Gradient alone needs no potential.
+  min.net_force_and_pot(pos_map(x), grad_data(grd, x), modgraph::FORCES);
+}
+
+
+double mirror_f(gsl_vector const *x, void *pmin) {
+  if(!x || !pmin) throw "null pointer";
+  auto &min= *(modgraph::minimizer *)pmin;
+  min.net_force_and_pot_mirror(pos_map(x), nullptr, modgraph::POTENTIAL);
+  return min.potential();
+}
+
+
+void mirror_fdf(
+    gsl_vector const *x, void *pmin, double *pot, gsl_vector *grd) {
+  if(!x || !pmin || !pot || !grd) throw "null pointer";
+  auto &min= *(modgraph::minimizer *)pmin;
+  min.net_force_and_pot_mirror(pos_map(x), grad_data(grd, x), modgraph::BOTH);
+  *pot= min.potential();
+}
+
+
+void mirror_df(gsl_vector const *x, void *pmin, gsl_vector *grd) {
+  if(!x || !pmin || !grd) throw "null pointer";
+  auto &min= *(modgraph::minimizer *)pmin;
+  min.net_force_and_pot_mirror(
+      pos_map(x), grad_data(grd, x), modgraph::FORCES);
 }
 }
 
@@ -61,6 +95,29 @@ void df(gsl_vector const *x, void *pmin, gsl_vector *grd) {
 namespace modgraph {
 
 
+gsl_multimin_fdfminimizer_type const *fdf_type(std::string const &name) {
+  struct entry {
+    char const *name;
+    gsl_multimin_fdfminimizer_type const *type;
+  };
+  entry const table[]= {
+      {"vector_bfgs2", gsl_multimin_fdfminimizer_vector_bfgs2},
+      {"vector_bfgs", gsl_multimin_fdfminimizer_vector_bfgs},
+      {"conjugate_pr", gsl_multimin_fdfminimizer_conjugate_pr},
+      {"conjugate_fr", gsl_multimin_fdfminimizer_conjugate_fr},
+      {"steepest_descent", gsl_multimin_fdfminimizer_steepest_descent}};
+  for(auto const &e: table) {
+    if(name == e.name) return e.type;
+  }
+  return nullptr;
+}
+
+
+bool known_algorithm(std::string const &name) {
+  return name == NM_SIMPLEX || name == NEWTON_CG || fdf_type(name);
+}
+
+
 void minimizer::minimize_nm_simplex(Matrix3Xd &positions) {
   constexpr int MAX_ITER= 1000000;
   unsigned const NUM_NODES= positions.cols();
@@ -69,11 +126,10 @@ void minimizer::minimize_nm_simplex(Matrix3Xd &positions) {
   /* Starting point */
   gsl_vector_view init= gsl_vector_view_array(&positions(0, 0), GSL_SIZE);
   gsl_vector *x= (gsl_vector *)&init;
-  cout << "x->size=" << x->size << endl;
 
   /* Set initial step-sizes. */
   gsl_vector *ss= gsl_vector_alloc(GSL_SIZE);
-  gsl_vector_set_all(ss, 10.0);
+  gsl_vector_set_all(ss, options_.step > 0.0 ? options_.step : 10.0);
 
   /* Initialize method and iterate */
   gsl_multimin_function minex_func;
@@ -82,12 +138,29 @@ void minimizer::minimize_nm_simplex(Matrix3Xd &positions) {
   minex_func.params= this;
 
   gsl_multimin_fminimizer_type const *T= gsl_multimin_fminimizer_nmsimplex2;
-  gsl_multimin_fminimizer *s= gsl_multimin_fminimizer_alloc(T, GSL_SIZE);
+  if(!f_workspace_ || f_workspace_->x->size != GSL_SIZE) {
+    f_workspace_.reset(gsl_multimin_fminimizer_alloc(T, GSL_SIZE));
+  }
+  gsl_multimin_fminimizer *s= f_workspace_.get();
+  // Simplex never measures gradient; so "mixed" cannot know when to switch,
+  // and only "float" selects single precision.
+  single_= (options_.precision == "float" && soa_forces_f_.size());
   gsl_multimin_fminimizer_set(s, &minex_func, x, ss);
 
+  double const tol= (options_.tol > 0.0 ? options_.tol : 0.1);
   int status= GSL_CONTINUE;
   int iter= 0;
   do {
+    snapshot(pos_map(s->x), iter, false);
+    if(out_of_budget()) {
+      spent_= true; // Best vertex so far is kept.
+      save_checkpoint(pos_map(s->x), iter, false);
+      break;
+    }
+    if(checkpoint_ && !checkpoint_(done_ + iter, s->fval)) {
+      cancelled_= true;
+      break;
+    }
     ++iter;
     status= gsl_multimin_fminimizer_iterate(s);
     if(status) {
@@ -99,17 +172,23 @@ void minimizer::minimize_nm_simplex(Matrix3Xd &positions) {
       break;
     }
     double const size= gsl_multimin_fminimizer_size(s);
-    status= gsl_multimin_test_size(size, 0.1);
-    if(status == GSL_SUCCESS) { printf("converged to minimum at\n"); }
-    printf("%5d f()=%7.3f size=%.3f\n", iter, s->fval, size);
+    status= gsl_multimin_test_size(size, tol);
+    if(telemetry_.due(iter)) {
+      telemetry_.report(iter, s->fval, size, false, false);
+    }
   } while(status == GSL_CONTINUE && iter < MAX_ITER);
+  iterations_= iter;
+  converged_= (status == GSL_SUCCESS && !cancelled_);
+  single_= false;
+  double const size= gsl_multimin_fminimizer_size(s);
+  telemetry_.report(iter, s->fval, size, true, converged_);
 
   positions= pos_map(s->x);
-  gsl_multimin_fminimizer_free(s);
+  gsl_vector_free(ss);
 }
 
 
-void minimizer::minimize_gradient(Matrix3Xd &positions) {
+void minimizer::minimize_gradient(Matrix3Xd &positions, bool mirror) {
   constexpr int MAX_ITER= 1000000;
   unsigned const NUM_NODES= positions.cols();
   unsigned const GSL_SIZE= 3 * NUM_NODES;
@@ -117,25 +196,71 @@ void minimizer::minimize_gradient(Matrix3Xd &positions) {
   /* Starting point */
   gsl_vector_view init= gsl_vector_view_array(&positions(0, 0), GSL_SIZE);
   gsl_vector *x= (gsl_vector *)&init;
-  cout << "x->size=" << x->size << endl;
 
   gsl_multimin_function_fdf minex_func;
   minex_func.n= GSL_SIZE;
-  minex_func.f= f;
-  minex_func.df= df;
-  minex_func.fdf= fdf;
+  minex_func.f= mirror ? mirror_f : f;
+  minex_func.df= mirror ? mirror_df : df;
+  minex_func.fdf= mirror ? mirror_fdf : fdf;
   minex_func.params= this;
 
-  gsl_multimin_fdfminimizer_type const *T=
-      gsl_multimin_fdfminimizer_conjugate_fr;
-  gsl_multimin_fdfminimizer *s= gsl_multimin_fdfminimizer_alloc(T, GSL_SIZE);
-  gsl_multimin_fdfminimizer_set(s, &minex_func, x, 1.0, 0.1);
+  gsl_multimin_fdfminimizer_type const *T= fdf_type(options_.algorithm);
+  if(!T) throw "unknown minimization-algorithm";
+  // Workspace is reused when neither type nor size change, as when cached
+  // graph be laid out again.
+  if(!fdf_workspace_ || fdf_workspace_->type != T ||
+      fdf_workspace_->x->size != GSL_SIZE) {
+    fdf_workspace_.reset(gsl_multimin_fdfminimizer_alloc(T, GSL_SIZE));
+  }
+  gsl_multimin_fdfminimizer *s= fdf_workspace_.get();
+  double const step= (options_.step > 0.0 ? options_.step : 1.0);
+  single_= (options_.precision != "double" && soa_forces_f_.size());
+  bool const mixed= single_ && options_.precision == "mixed";
+  gsl_multimin_fdfminimizer_set(s, &minex_func, x, step, options_.line_tol);
+  double const tol= (options_.tol > 0.0 ? options_.tol : 1.0E-05);
+  // Single precision cannot resolve gradient much finer than this.
+  double const tol_f= 1.0E+03 * tol;
+
+  // Rounding of positions to single precision eventually hides every step
+  // from potential; so single precision is abandoned after this many
+  // iterations without decrease.
+  constexpr int MAX_STALL= 10;
+  int stalls= 0;
+  double last_f= s->f;
+
+  // Restart in double precision from current iterate.
+  auto const to_double= [&] {
+    single_= false;
+    positions= pos_map(s->x);
+    gsl_multimin_fdfminimizer_set(s, &minex_func, x, step, options_.line_tol);
+  };
 
   int status= GSL_CONTINUE;
   int iter= 0;
   do {
+    snapshot(pos_map(s->x), iter, mirror);
+    if(out_of_budget()) {
+      spent_= true; // Current iterate is best so far.
+      save_checkpoint(pos_map(s->x), iter, mirror);
+      break;
+    }
+    if(checkpoint_ && !checkpoint_(done_ + iter, s->f)) {
+      cancelled_= true; // Start trails best start.
+      break;
+    }
     ++iter;
     status= gsl_multimin_fdfminimizer_iterate(s);
+    if(single_ && !status) {
+      stalls= (s->f < last_f ? 0 : stalls + 1);
+      last_f= s->f;
+      if(stalls >= MAX_STALL) status= GSL_ENOPROG;
+    }
+    if(status && single_ && mixed) {
+      // Single precision can make no more progress.
+      to_double();
+      status= GSL_CONTINUE;
+      continue;
+    }
     if(status) {
       if(status == GSL_ENOPROG) {
         cerr << "GSL_ENOPROG returned from gsl_multimin_*iterate()" << endl;
@@ -144,13 +269,27 @@ void minimizer::minimize_gradient(Matrix3Xd &positions) {
       }
       break;
     }
-    status= gsl_multimin_test_gradient(s->gradient, 1.0E-05);
-    if(status == GSL_SUCCESS) { printf("converged to minimum at\n"); }
-    printf("%5d f()=%8.4f\n", iter, s->f);
+    status= gsl_multimin_test_gradient(s->gradient, single_ ? tol_f : tol);
+    if(status == GSL_SUCCESS && single_ && mixed) {
+      to_double();
+      status= GSL_CONTINUE;
+    }
+    if(telemetry_.due(iter)) {
+      double const norm= gsl_blas_dnrm2(s->gradient);
+      telemetry_.report(iter, s->f, norm, false, false);
+    }
   } while(status == GSL_CONTINUE && iter < MAX_ITER);
+  iterations_= iter;
+  converged_= (status == GSL_SUCCESS && !cancelled_);
+  single_= false;
+  double const norm= gsl_blas_dnrm2(s->gradient);
+  // Constrained stage, like local stage of incremental layout, is followed
+  // by unconstrained stage, unless budget ran out.
+  bool const last= (!mirror && held_.empty()) || spent_;
+  bool const done= converged_ && !mirror && held_.empty();
+  telemetry_.report(iter, s->f, norm, last, done);
 
   positions= pos_map(s->x);
-  gsl_multimin_fdfminimizer_free(s);
 }
 
 
@@ -1,14 +1,18 @@
 
 /// @file       gsl-funcs.hpp
 /// @copyright  2022 Thomas E. Vaughan, all rights reserved.
-/// @brief      Declaration of f(), df(), and fdf().
+/// @brief      Declaration of f(), df(), fdf(), and modgraph::fdf_type().
 ///
 /// Each of f(), df(), and fdf() has C-linkage and is passed by
 /// function-pointer to one of GSL's minimization-routines.
 /// - Each of df() and fdf() is used when derivative is needed.
 /// - f() just provides value to minimize.
 
+#pragma once
+
+#include <gsl/gsl_multimin.h> // gsl_multimin_fdfminimizer_type
 #include <gsl/gsl_vector.h> // gsl_vector
+#include <string> // string
 
 
 extern "C" {
@@ -38,7 +42,58 @@ void df(gsl_vector const *x, void *p, gsl_vector *g);
 /// @param f  Pointer to (output) potential to be minimized.
 /// @param g  Pointer to (output) components of gradient.
 void fdf(gsl_vector const *x, void *p, double *f, gsl_vector *g);
+
+
+/// Potential, as by f(), for mirror-constrained minimization.
+/// @param x  Pointer to reduced position-components of representatives.
+/// @param p  Pointer to instance of class minimizer.
+/// @return   Potential to be minimized.
+double mirror_f(gsl_vector const *x, void *p);
+
+
+/// Reduced gradient, as by df(), for mirror-constrained minimization.
+/// @param x  Pointer to reduced position-components of representatives.
+/// @param p  Pointer to instance of class minimizer.
+/// @param g  Pointer to (output) components of reduced gradient.
+void mirror_df(gsl_vector const *x, void *p, gsl_vector *g);
+
+
+/// Potential and reduced gradient, as by fdf(), for mirror-constrained
+/// minimization.
+/// @param x  Pointer to reduced position-components of representatives.
+/// @param p  Pointer to instance of class minimizer.
+/// @param f  Pointer to (output) potential to be minimized.
+/// @param g  Pointer to (output) components of reduced gradient.
+void mirror_fdf(gsl_vector const *x, void *p, double *f, gsl_vector *g);
 }
 
 
+namespace modgraph {
+
+
+/// Name of GSL's only minimization-algorithm that does not use forces.
+constexpr char const NM_SIMPLEX[]= "nmsimplex2";
+
+
+/// Name of truncated-Newton method, which is not GSL's but uses analytic
+/// products of Hessian; see modgraph::minimizer::hessian_times().
+constexpr char const NEWTON_CG[]= "newton_cg";
+
+
+/// GSL's gradient-minimizer of given name.
+/// @param name  Name of minimizer, like "vector_bfgs2" or "conjugate_fr".
+/// @return  Type of minimizer, or null if name be unknown.
+gsl_multimin_fdfminimizer_type const *fdf_type(std::string const &name);
+
+
+/// True if name be that of GSL's gradient-minimizer, NM_SIMPLEX, or
+/// NEWTON_CG.
+/// @param name  Name of minimizer.
+/// @return  True if name be known.
+bool known_algorithm(std::string const &name);
+
+
+} // namespace modgraph
+
+
 // EOF
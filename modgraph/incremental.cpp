@@ -0,0 +1,82 @@
+/// @file       incremental.cpp
+/// @brief      Definition of modgraph::changed_nodes() and
+///             modgraph::incremental_start().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "incremental.hpp"
+#include "graph.hpp" // squares
+#include <algorithm> // fill, min
+#include <random> // mt19937, normal_distribution, seed_seq
+
+using Eigen::Matrix3Xd;
+using Eigen::Vector3d;
+using std::vector;
+
+
+namespace modgraph {
+
+
+vector<char> changed_nodes(
+    springs::matrix const &prev, springs::matrix const &cur) {
+  // Each spring is stored once, in row of lesser node; so every spring of
+  // node is in its row of symmetric sum.
+  springs::matrix const p= prev + springs::matrix(prev.transpose());
+  springs::matrix const c= cur + springs::matrix(cur.transpose());
+  int const n= c.rows();
+  vector<char> r(n, 1); // Return-value.
+  for(int i= 0; i < std::min<int>(n, p.rows()); ++i) {
+    springs::matrix::InnerIterator a(p, i), b(c, i);
+    for(; a && b; ++a, ++b) {
+      if(a.col() != b.col() || a.value() != b.value()) break;
+    }
+    r[i]= (a || b);
+  }
+  return r;
+}
+
+
+Matrix3Xd incremental_start(
+    squares const &g, Matrix3Xd const &prev, unsigned seed) {
+  int const m= g.modulus;
+  int const k= std::min<int>(m, prev.cols()); // Nodes kept.
+  Matrix3Xd r(3, m); // Return-value.
+  r.leftCols(k)= prev.leftCols(k);
+  Vector3d const center=
+      (prev.cols() ? Vector3d(prev.rowwise().mean()) : Vector3d::Zero());
+  vector<char> placed(m, 0);
+  std::fill(placed.begin(), placed.begin() + k, 1);
+  // Private generator keeps placement reproducible.
+  std::seed_seq seq({unsigned(m), seed});
+  std::mt19937 gen(m);
+  if(seed) gen.seed(seq);
+  std::normal_distribution<double> normal;
+  auto const place= [&](int i, Vector3d const &near) {
+    Vector3d const d(normal(gen), normal(gen), normal(gen));
+    r.col(i)= near + d.normalized();
+    placed[i]= 1;
+  };
+  for(int i= k; i < m; ++i) {
+    if(placed[i]) continue;
+    // Follow successors to first placed node, and place path back from it;
+    // path that closes on itself is anchored at centroid.
+    vector<int> path;
+    int j= i;
+    while(!placed[j]) {
+      path.push_back(j);
+      placed[j]= 2; // On path.
+      j= g.next(j);
+      if(placed[j] == 2) break;
+    }
+    Vector3d near= (placed[j] == 1 ? Vector3d(r.col(j)) : center);
+    for(auto a= path.rbegin(); a != path.rend(); ++a) {
+      place(*a, near);
+      near= r.col(*a);
+    }
+  }
+  return r;
+}
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,54 @@
+/// @file       incremental.hpp
+/// @brief      Declaration of modgraph::changed_nodes() and
+///             modgraph::incremental_start().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+///
+/// Incremental layout starts from earlier layout of nearby modulus or of
+/// nearby strengths, rather than from random positions.
+/// - Node whose springs are unchanged keeps its earlier position; node new
+///   to graph is placed near its successor.
+/// - Changed and new nodes are relaxed first, with every other node held in
+///   place (see minimizer::warm_start()); then every node is relaxed from
+///   near minimum.
+
+#pragma once
+
+#include "springs.hpp" // springs
+#include <eigen3/Eigen/Core> // Matrix3Xd
+#include <vector> // vector
+
+namespace modgraph {
+
+
+class squares;
+
+
+/// Nodes whose springs differ between earlier and current list of springs.
+/// - Springs of node are every entry of its row and of its column.
+/// - Node beyond earlier list counts as changed.
+/// @param prev  Spring-constants of earlier layout.
+/// @param cur  Spring-constants of current layout.
+/// @return  For each node of current list, 1 if its springs changed, or
+///          else 0.
+std::vector<char> changed_nodes(
+    springs::matrix const &prev, springs::matrix const &cur);
+
+
+/// Starting positions for graph from earlier layout.
+/// - Node present in earlier layout keeps its position.
+/// - Every other node is placed at unit distance in random direction from
+///   its successor, as by multilevel refinement, or from centroid of
+///   earlier layout if no successor along its path be placed.
+/// - Random directions are drawn from generator seeded by modulus and by
+///   `seed`, as for multilevel placement.
+/// @param g  Tables of graph.
+/// @param prev  3xM matrix of earlier positions, for any M.
+/// @param seed  Seed, as for options::seed.
+/// @return  3xN matrix for position of each of N nodes of `g`.
+Eigen::Matrix3Xd incremental_start(
+    squares const &g, Eigen::Matrix3Xd const &prev, unsigned seed);
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,130 @@
+/// @file       layout-cache.cpp
+/// @brief      Definition of modgraph::layout_key and modgraph::layout_cache.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "layout-cache.hpp"
+#include "position-file.hpp" // read_positions, write_positions
+#include <cmath> // abs
+#include <cstdint> // uint64_t
+#include <cstring> // memcpy
+#include <filesystem> // directory_iterator
+#include <iomanip> // hex, setw, setfill
+#include <sstream> // ostringstream
+
+namespace fs= std::filesystem;
+using Eigen::Matrix3Xd;
+using std::string;
+
+
+namespace modgraph {
+
+
+/// Relative difference between two positive parameters.
+/// @param a  One parameter.
+/// @param b  Other parameter.
+/// @return  Relative difference.
+double rel_diff(double a, double b) {
+  double const s= std::abs(a) + std::abs(b);
+  return s > 0.0 ? std::abs(a - b) / s : 0.0;
+}
+
+
+double layout_key::distance(layout_key const &k) const {
+  return rel_diff(edge_attract, k.edge_attract) +
+         rel_diff(sum_attract, k.sum_attract) +
+         rel_diff(factor_attract, k.factor_attract) +
+         std::abs(theta - k.theta);
+}
+
+
+bool layout_key::operator==(layout_key const &k) const {
+  return modulus == k.modulus && edge_attract == k.edge_attract &&
+         sum_attract == k.sum_attract && factor_attract == k.factor_attract &&
+         theta == k.theta;
+}
+
+
+/// First bytes of every cached layout.
+constexpr char MAGIC[8]= {'m', 'o', 'd', 'g', 'p', 'o', 's', '1'};
+
+
+/// Header at start of every cached layout, followed by 3xN doubles.
+struct header {
+  char magic[8]; ///< Copy of MAGIC.
+  layout_key key; ///< Key for layout.
+  int32_t nodes; ///< Number N of nodes.
+};
+
+
+/// Read header and (optionally) positions from cached layout.
+/// @param file  Path of file.
+/// @param h  On successful return, header of file.
+/// @param pos  If nonnull, on successful return, positions.
+/// @return  True on success.
+bool read_layout(fs::path const &file, header &h, Matrix3Xd *pos) {
+  return read_positions(file.string(), MAGIC, h, pos);
+}
+
+
+string layout_key::stem() const {
+  uint64_t h= 14695981039346656037ull;
+  double const d[]= {edge_attract, sum_attract, factor_attract, theta};
+  unsigned char b[sizeof(d)];
+  std::memcpy(b, d, sizeof(d));
+  for(unsigned char c: b) h= (h ^ c) * 1099511628211ull;
+  std::ostringstream oss;
+  oss << modulus << "-" << std::hex << std::setw(16) << std::setfill('0')
+      << h;
+  return oss.str();
+}
+
+
+string layout_cache::path(layout_key const &k) const {
+  // Hash of parameters names file; header holds parameters exactly.
+  return (fs::path(dir_) / (k.stem() + ".pos")).string();
+}
+
+
+layout_cache::layout_cache(string const &dir): dir_(dir) {}
+
+
+bool layout_cache::load(layout_key const &k, Matrix3Xd &pos) const {
+  header h;
+  return read_layout(path(k), h, &pos) && h.key == k;
+}
+
+
+bool layout_cache::load_nearest(layout_key const &k, Matrix3Xd &pos) const {
+  std::error_code ec;
+  fs::directory_iterator it(dir_, ec);
+  if(ec) return false;
+  string const prefix= std::to_string(k.modulus) + "-";
+  fs::path best;
+  double best_distance= 0.0;
+  for(auto const &e: it) {
+    string const name= e.path().filename().string();
+    if(name.compare(0, prefix.size(), prefix) != 0) continue;
+    header h;
+    if(!read_layout(e.path(), h, nullptr) || h.key.modulus != k.modulus) {
+      continue;
+    }
+    double const d= k.distance(h.key);
+    if(best.empty() || d < best_distance) {
+      best= e.path();
+      best_distance= d;
+    }
+  }
+  header h;
+  return !best.empty() && read_layout(best, h, &pos);
+}
+
+
+void layout_cache::store(layout_key const &k, Matrix3Xd const &pos) const {
+  header const h= new_header<header>(MAGIC, k, pos.cols());
+  write_positions(path(k), &h, sizeof(h), pos, "layout_cache");
+}
+
+
+} // namespace modgraph
+
+// EOF
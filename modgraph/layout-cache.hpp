@@ -0,0 +1,83 @@
+/// @file       layout-cache.hpp
+/// @brief      Declaration of modgraph::layout_key and modgraph::layout_cache.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include <eigen3/Eigen/Core> // Matrix3Xd
+#include <string> // string
+
+namespace modgraph {
+
+
+/// Everything that determines potential minimized for graph.
+struct layout_key {
+  int modulus; ///< Modulus of graph.
+  double edge_attract; ///< Scale of attraction along directed edge.
+  double sum_attract; ///< Relative scale of attraction by sum.
+  double factor_attract; ///< Relative scale of attraction by factor.
+  double theta; ///< Opening angle for approximate repulsion (0 if exact).
+
+  /// Distance between parameters of this key and those of another key, for
+  /// choosing nearest cached layout.
+  /// @param k  Other key.
+  /// @return  Sum of relative differences between parameters.
+  double distance(layout_key const &k) const;
+
+  /// True if every parameter of this key be identical to that of other key.
+  /// @param k  Other key.
+  /// @return  True if keys be identical.
+  bool operator==(layout_key const &k) const;
+
+  /// Name, unique to modulus and parameters, of every file made for key.
+  /// - FNV-1a hash of parameters follows modulus; so file for other
+  ///   parameters never collides, though header of file should still hold
+  ///   parameters exactly.
+  /// @return  Stem like "33-0123456789abcdef".
+  std::string stem() const;
+};
+
+
+/// Directory of final positions, each stored in compact binary file, keyed
+/// by modulus and by parameters of potential.
+/// - Cached positions for identical key make minimization unnecessary.
+/// - Cached positions for same modulus and different parameters make good
+///   starting point for minimization.
+/// - Files are written atomically (via rename), so that several processes
+///   may safely share directory.
+/// - Failure to read or to write cache is reported but is never fatal.
+class layout_cache {
+  std::string dir_; ///< Directory holding cached layouts.
+
+  /// Name of file for key.
+  /// @param k  Key for layout.
+  /// @return  Path of file.
+  std::string path(layout_key const &k) const;
+
+public:
+  /// Initialize directory.
+  /// @param dir  Directory, which is created if necessary on first store().
+  layout_cache(std::string const &dir);
+
+  /// Load positions stored for identical key.
+  /// @param k  Key for layout.
+  /// @param pos  On successful return, 3xN matrix of positions.
+  /// @return  True if positions were found.
+  bool load(layout_key const &k, Eigen::Matrix3Xd &pos) const;
+
+  /// Load positions stored for same modulus and nearest parameters.
+  /// @param k  Key for layout.
+  /// @param pos  On successful return, 3xN matrix of positions.
+  /// @return  True if any layout for modulus was found.
+  bool load_nearest(layout_key const &k, Eigen::Matrix3Xd &pos) const;
+
+  /// Store positions for key.
+  /// @param k  Key for layout.
+  /// @param pos  3xN matrix of positions.
+  void store(layout_key const &k, Eigen::Matrix3Xd const &pos) const;
+};
+
+
+} // namespace modgraph
+
+// EOF
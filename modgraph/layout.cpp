@@ -0,0 +1,71 @@
+/// @file       layout.cpp
+/// @brief      Definition of modgraph::layout() and modgraph::write_scene().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "layout.hpp"
+#include "asy-writer.hpp" // write_asy
+#include "graph.hpp" // graph
+#include "telemetry.hpp" // telemetry
+
+namespace modgraph {
+
+
+/// Layout in memory of graph already laid out.
+/// @param g  Graph.
+/// @param t0  Time at which construction of graph began.
+/// @return  Layout.
+static layout_result result(graph const &g, telemetry::clock::time_point t0) {
+  minimizer const &mz= g.layout_minimizer();
+  std::chrono::duration<double> const d= telemetry::clock::now() - t0;
+  return {g.modulus,
+      mz.positions(),
+      g.edges(),
+      mz.potential(),
+      mz.iterations(),
+      mz.evaluations(),
+      mz.converged(),
+      mz.budget_spent(),
+      d.count()};
+}
+
+
+layout_result layout(int m, options const &o) {
+  auto const t0= telemetry::clock::now();
+  graph g(m, o);
+  g.layout();
+  return result(g, t0);
+}
+
+
+layout_result layout(int m,
+    options const &o,
+    layout_result const &prev,
+    options const &prev_o) {
+  auto const t0= telemetry::clock::now();
+  graph g(m, o);
+  if(prev.positions.cols() != prev.modulus) throw "malformed earlier layout";
+  // Springs of earlier layout depend only on modulus and strengths; so
+  // neither positions nor threads nor buffers are made for it.
+  springs const p(squares(prev.modulus),
+      prev_o.edge_attract,
+      prev_o.sum_attract,
+      prev_o.factor_attract);
+  g.layout_from(p.k(), prev.positions);
+  return result(g, t0);
+}
+
+
+void write_scene(layout_result const &r,
+    std::string const &stem,
+    std::string const &format) {
+  if(format == "ply") {
+    write_ply(stem + ".ply", r.positions, r.edges);
+  } else {
+    write_asy(stem + ".asy", r.positions, r.edges);
+  }
+}
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,78 @@
+/// @file       layout.hpp
+/// @brief      Declaration of modgraph::layout() and modgraph::write_scene().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+///
+/// Interface of libmodgraph.a for program that renders layout itself.
+/// - layout() returns positions, edges, and statistics in memory; no file is
+///   read or written (unless options name cache or checkpoints).
+/// - write_scene() writes same file as modgraph would, as separate step.
+
+#pragma once
+
+#include "options.hpp" // options
+#include "ply-writer.hpp" // edge
+#include <eigen3/Eigen/Core> // Matrix3Xd
+#include <string> // string
+#include <vector> // vector
+
+namespace modgraph {
+
+
+/// Final layout of graphs of squares for one modulus.
+/// - Arrays are contiguous: `positions.data()` points to x, y, and z of
+///   Node 0, then of Node 1, and so on (3N doubles); `edges.data()` may be
+///   read as tail and head of each edge in turn (2E ints).
+struct layout_result {
+  int modulus; ///< Modulus, equal to number N of nodes.
+  Eigen::Matrix3Xd positions; ///< 3xN matrix of final positions.
+  std::vector<edge> edges; ///< Directed edges, in increasing order of tail.
+  double potential; ///< Potential at final positions.
+  int iterations; ///< Number of iterations of minimizer.
+  int evaluations; ///< Number of evaluations of potential or forces.
+  bool converged; ///< True if minimizer converged.
+  bool budget_spent; ///< True if deadline or budget stopped minimizer.
+  double seconds; ///< Wall-clock time of construction and layout.
+};
+
+
+/// Lay out graphs of squares for modulus.
+/// - Progress is reported as options direct; set progress_format to "none"
+///   for silence.
+/// - Exception of type `char const*` is thrown for illegal modulus or
+///   options.
+/// @param m  Modulus (at least 2).
+/// @param o  Run-time options governing layout.
+/// @return  Layout in memory.
+layout_result layout(int m, options const &o= options());
+
+
+/// Lay out graphs of squares for modulus incrementally from earlier layout
+/// (typically of nearby modulus, or with slightly different strengths), as
+/// described in incremental.hpp.
+/// - Exception of type `char const*` is thrown for illegal modulus or
+///   options.
+/// @param m  Modulus (at least 2).
+/// @param o  Run-time options governing layout.
+/// @param prev  Earlier layout.
+/// @param prev_o  Options of earlier layout, whose strengths of attraction
+///                determine its springs.
+/// @return  Layout in memory.
+layout_result layout(int m,
+    options const &o,
+    layout_result const &prev,
+    options const &prev_o);
+
+
+/// Write scene for layout.
+/// @param r  Layout.
+/// @param stem  Name of file without extension, like "33".
+/// @param format  "asy" for text-file for asymptote, or "ply" for binary
+///                PLY-file.
+void write_scene(layout_result const &r,
+    std::string const &stem,
+    std::string const &format= "asy");
+
+
+} // namespace modgraph
+
+// EOF
@@ -2,12 +2,18 @@
 /// @brief      Definition of modgraph::minimizer.
 /// @copyright  2022 Thomas E. Vaughan, all rights reserved.
 
-#if 0
-#define NM_SIMPLEX
-#endif
-
 #include "minimizer.hpp"
+#include "checkpoint.hpp" // checkpoint_dir
 #include "graph.hpp"
+#include "gsl-funcs.hpp" // NEWTON_CG, NM_SIMPLEX
+#include "layout-cache.hpp" // layout_cache
+#include "multilevel.hpp" // coarse_layout
+#include "race.hpp" // race
+#include "scheduler.hpp" // scheduler
+#include <algorithm> // count, max
+#include <chrono> // duration, duration_cast
+#include <cstdio> // snprintf
+#include <random> // mt19937, uniform_real_distribution
 
 using Eigen::Matrix3Xd;
 using Eigen::MatrixXd;
@@ -18,131 +24,644 @@ using std::vector;
 namespace modgraph {
 
 
-/// Calculate factors of `m`.
-/// - Include 0, which represents `m` in modular arithmetic.
-/// - Do not include 1 as a factor.
-/// @param m  Positive integer whose factors are calculated.
-/// @return  List of nontrivial factors.
-vector<int> calculate_factors(int m) {
-  vector<int> f({0});
-  for(int i= 2; i <= m / 2; ++i) {
-    if((m % i) == 0) f.push_back(i);
+/// Split rows [0, n) into contiguous tiles of nearly equal work.
+/// @param n  Number of rows.
+/// @param t  Number of tiles.
+/// @param work  Function returning amount of work in given row.
+/// @return  First row of each tile, followed by n.
+template<typename W> vector<int> split_rows(int n, int t, W const &work) {
+  double total= 0.0;
+  for(int i= 0; i < n; ++i) total+= work(i);
+  vector<int> r({0}); // Return-value.
+  double done= 0.0;
+  for(int i= 0; i < n && int(r.size()) < t; ++i) {
+    done+= work(i);
+    if(done >= total * r.size() / t) r.push_back(i + 1);
   }
-  return f;
+  while(int(r.size()) <= t) r.push_back(n);
+  return r;
 }
 
 
-Vector3d minimizer::attract(double k, node_pair const &np) {
-  potential_+= 0.5 * k * np.r() * np.r();
-  return np.u() * k * np.r();
+template<bool P, bool F>
+double minimizer::attract(Eigen::Ref<Matrix3Xd const> const &pos,
+    int b,
+    int e,
+    Eigen::Map<Matrix3Xd> &g) const {
+  auto const &k= springs_.k();
+  double u= 0.0; // Return-value.
+  for(int i= b; i < e; ++i) {
+    for(springs::matrix::InnerIterator s(k, i); s; ++s) {
+      // Spring-force felt by Node i is proportional to displacement from Node
+      // i to Node j.
+      Vector3d const d= pos.col(s.col()) - pos.col(i);
+      if constexpr(P) u+= 0.5 * s.value() * d.squaredNorm();
+      if constexpr(F) {
+        g.col(i)-= s.value() * d;
+        g.col(s.col())+= s.value() * d;
+      }
+    }
+  }
+  return u;
 }
 
 
-Vector3d minimizer::repel(node_pair const &np) {
-  potential_+= 1.0 / np.r();
-  return -np.u() / (np.r() * np.r());
+double minimizer::repel_tile_f(int t, int b, int e, int stride, quantities q) {
+  // Force on Node j accumulates over every row i < j; so single-precision
+  // accumulator is folded into double-precision accumulator every FOLD rows,
+  // which bounds rounding error.  Rows [c, i] touch only nodes from c on.
+  constexpr int FOLD= 64;
+  bool const forces= q & FORCES;
+  soa &s= soa_forces_[t];
+  soa_f &sf= soa_forces_f_[t];
+  if(forces) {
+    s.setZero();
+    sf.setZero();
+  }
+  int const n= soa_positions_f_.rows();
+  double u= 0.0; // Return-value.
+  for(int c= b; c < e; c+= FOLD * stride) {
+    int const l= std::min(c + FOLD * stride, e);
+    for(int i= c; i < l; i+= stride) {
+      u+= repel_row(soa_positions_f_, i, sf, q);
+    }
+    if(forces) {
+      s.bottomRows(n - c)+= sf.bottomRows(n - c).cast<double>();
+      sf.bottomRows(n - c).setZero();
+    }
+  }
+  return u;
 }
 
 
-Vector3d minimizer::edge_attract(node_pair const &np) {
-  auto const &i= np.i();
-  auto const &j= np.j();
-  if(graph_.next(i) == j || graph_.next(j) == i) {
-    return attract(1.0 / edge_attract_, np);
+void minimizer::tile(Eigen::Ref<Matrix3Xd const> const &pos,
+    double *grad,
+    int t,
+    quantities q) {
+  bool const forces= q & FORCES;
+  // Gradient is *negative* of net force.
+  Eigen::Map<Matrix3Xd> g(
+      t == 0 ? grad : partial_grads_[t].data(), 3, forces ? pos.cols() : 0);
+  if(forces) g.setZero();
+  double u= 0.0;
+  if(options_.theta > 0.0) {
+    // Approximate repulsion via octree.
+    double r= 0.0; // Sum over nodes of 1/r to every other node.
+    for(int i= node_tiles_[t]; i < node_tiles_[t + 1]; ++i) {
+      Vector3d fi= Vector3d::Zero();
+      r+= octree_.repel(i, options_.theta, fi, q);
+      if(forces) g.col(i)-= fi;
+    }
+    u+= 0.5 * r; // Each pair was counted twice.
+  } else {
+    // Repel exactly, with Node i in each row of tile taking part in pair with
+    // every Node j > i.
+    soa &s= soa_forces_[t];
+    if(single_) {
+      u+= repel_tile_f(t, pair_tiles_[t], pair_tiles_[t + 1], 1, q);
+    } else {
+      if(forces) s.setZero();
+      for(int i= pair_tiles_[t]; i < pair_tiles_[t + 1]; ++i) {
+        u+= repel_row(soa_positions_, i, s, q);
+      }
+    }
+    if(forces) g-= s.transpose();
+  }
+  // Attract by springs.
+  int const b= spring_tiles_[t], e= spring_tiles_[t + 1];
+  switch(q) {
+    case POTENTIAL: u+= attract<true, false>(pos, b, e, g); break;
+    case FORCES: u+= attract<false, true>(pos, b, e, g); break;
+    case BOTH: u+= attract<true, true>(pos, b, e, g); break;
   }
-  return Vector3d::Zero();
+  partial_pot_[t]= u;
 }
 
 
-Vector3d minimizer::sum_attract(node_pair const &np) {
-  Vector3d f= Vector3d::Zero();
-  int const m= graph_.modulus;
-  int const sum= (np.i() + np.j()) % m;
-  static vector<int> const factors= calculate_factors(m);
-  double const c= 1.0L / sum_attract_;
-  double const b= c / m;
-  for(int n: factors) {
-    double const a= n * b;
-    // If sum of i and j be factor of m, then attract i toward j. Attraction is
-    // usually proportional to factor but proportional to m if i or j be zero.
-    if(sum == n) f+= attract((n == 0 ? c : a), np);
-    // If sum of i and j be less than m by factor of m, then attract i toward
-    // j. Attraction is proportional to factor.
-    if(m - sum == n) f+= attract(a, np);
+void minimizer::net_force_and_pot(
+    Eigen::Ref<Matrix3Xd const> const &pos, double *grad, quantities q) {
+  if((q & FORCES) && !grad) throw "null pointer to gradient";
+  auto const t0= telemetry_.start();
+  if(gpu_) {
+    double const u= gpu_->evaluate(pos.data(), grad, q);
+    if(q & POTENTIAL) potential_= u;
+    if(q & FORCES) hold(grad);
+    telemetry_.finish(q, t0);
+    return;
   }
-  return f;
+  if(options_.theta > 0.0) {
+    octree_.build(pos);
+  } else if(single_) {
+    soa_positions_f_= pos.transpose().cast<float>();
+  } else {
+    soa_positions_= pos.transpose();
+  }
+  pool_.run([&](int t) { tile(pos, grad, t, q); });
+  if(q & POTENTIAL) {
+    potential_= partial_pot_[0];
+    for(int t= 1; t < pool_.size(); ++t) potential_+= partial_pot_[t];
+  }
+  if(q & FORCES) {
+    Eigen::Map<Matrix3Xd> g(grad, 3, pos.cols());
+    for(int t= 1; t < pool_.size(); ++t) g+= partial_grads_[t];
+    hold(grad);
+  }
+  telemetry_.finish(q, t0);
+}
+
+
+void minimizer::hess_tile(
+    Eigen::Ref<Matrix3Xd const> const &v, double *hv, int t) {
+  Eigen::Map<Matrix3Xd> h(
+      t == 0 ? hv : partial_grads_[t].data(), 3, v.cols());
+  h.setZero();
+  attract<false, true>(v, spring_tiles_[t], spring_tiles_[t + 1], h);
+  soa &s= soa_forces_[t];
+  s.setZero();
+  for(int i= pair_tiles_[t]; i < pair_tiles_[t + 1]; ++i) {
+    hess_row(soa_positions_, soa_direction_, i, s);
+  }
+  h+= s.transpose();
+}
+
+
+void minimizer::hessian_times(Eigen::Ref<Matrix3Xd const> const &pos,
+    Eigen::Ref<Matrix3Xd const> const &v,
+    double *hv) {
+  if(!hv) throw "null pointer to product";
+  if(options_.theta > 0.0) throw "Hessian requires exact repulsion";
+  soa_positions_= pos.transpose();
+  soa_direction_= v.transpose();
+  pool_.run([&](int t) { hess_tile(v, hv, t); });
+  Eigen::Map<Matrix3Xd> h(hv, 3, v.cols());
+  for(int t= 1; t < pool_.size(); ++t) h+= partial_grads_[t];
+  hold(hv);
+  ++products_;
 }
 
 
-Vector3d minimizer::factor_attract(node_pair const &np) {
-  Vector3d f= Vector3d::Zero();
+/// Diagonal of reflection through plane x = 0.
+static Vector3d const reflect(-1.0, 1.0, 1.0);
+
+
+void minimizer::mirror_expand(Eigen::Ref<Matrix3Xd const> const &red) {
   int const m= graph_.modulus;
-  static vector<int> const factors= calculate_factors(m);
-  double const c= 1.0L / factor_attract_;
-  double const b= c / m;
-  auto const &i= np.i();
-  auto const &j= np.j();
-  for(int n: factors) {
-    double const a= n * b;
-    // If either i or j be factor of m, then attract i toward j. Attraction is
-    // usually proportional to factor but proportional to m if i or j be zero.
-    if(i == n || j == n) f+= attract((n == 0 ? c : a), np);
-    // If either i or j be less than m by factor of m, then attract i toward j.
-    // Attraction is proportional to factor.
-    if(i == m - n || j == m - n) f+= attract(a, np);
+  for(unsigned a= 0; a < mirror_reps_.size(); ++a) {
+    int const i= mirror_reps_[a];
+    int const j= (m - i) % m; // Mirror of Node i.
+    mirror_pos_.col(i)= red.col(a);
+    if(j == i) {
+      mirror_pos_(0, i)= 0.0; // Node is its own mirror.
+    } else {
+      mirror_pos_.col(j)= reflect.cwiseProduct(red.col(a));
+    }
+  }
+}
+
+
+void minimizer::mirror_tile(int t, quantities q) {
+  bool const forces= q & FORCES;
+  int const n= mirror_order_.size();
+  double *const d= (t == 0 ? mirror_grad_.data() : partial_grads_[t].data());
+  Eigen::Map<Matrix3Xd> g(d, 3, forces ? n : 0);
+  if(forces) g.setZero();
+  // Row 2a is representative, and row 2a + 1 is its mirror; every pair of
+  // rows from 2a on is covered by rows of later representatives.
+  int const b= 2 * mirror_tiles_[t], e= 2 * mirror_tiles_[t + 1];
+  soa &s= soa_forces_[t];
+  double u= 0.0;
+  if(single_) {
+    u+= repel_tile_f(t, b, e, 2, q);
+  } else {
+    if(forces) s.setZero();
+    for(int i= b; i < e; i+= 2) u+= repel_row(soa_positions_, i, s, q);
+  }
+  if(forces) {
+    for(int r= b; r < n; ++r) {
+      g.col(mirror_order_[r])-= 2.0 * s.row(r).transpose();
+    }
+  }
+  u*= 2.0; // Each pair stands for its orbit under mirror-map.
+  int const sb= spring_tiles_[t], se= spring_tiles_[t + 1];
+  switch(q) {
+    case POTENTIAL: u+= attract<true, false>(mirror_pos_, sb, se, g); break;
+    case FORCES: u+= attract<false, true>(mirror_pos_, sb, se, g); break;
+    case BOTH: u+= attract<true, true>(mirror_pos_, sb, se, g); break;
   }
-  return f;
+  partial_pot_[t]= u;
 }
 
 
-Vector3d minimizer::force_and_pot(node_pair const &np) {
-  Vector3d f= Vector3d::Zero();
-  f+= repel(np); // Repel by inverse-square law.
-  f+= edge_attract(np); // Attract along graph-edge by spring.
-  f+= sum_attract(np); // Attract because of sum of i and j.
-  f+= factor_attract(np); // Attract 0 to 1 and vice-versa.
-  return f;
+void minimizer::mirror_evaluate(quantities q) {
+  auto const t0= telemetry_.start();
+  int const n= mirror_order_.size();
+  for(int r= 0; r < n; ++r) {
+    auto const p= mirror_pos_.col(mirror_order_[r]).transpose();
+    if(single_) {
+      soa_positions_f_.row(r)= p.cast<float>();
+    } else {
+      soa_positions_.row(r)= p;
+    }
+  }
+  pool_.run([&](int t) { mirror_tile(t, q); });
+  double u= 0.0;
+  for(int t= 0; t < pool_.size(); ++t) u+= partial_pot_[t];
+  if(q & FORCES) {
+    for(int t= 1; t < pool_.size(); ++t) mirror_grad_+= partial_grads_[t];
+  }
+  // Add w/r between Nodes i and j.
+  auto const pair= [&](int i, int j, double w) {
+    Vector3d const d= mirror_pos_.col(i) - mirror_pos_.col(j);
+    double const r= 1.0 / d.norm();
+    u+= w * r;
+    if(q & FORCES) {
+      Vector3d const f= (w * r * r * r) * d;
+      mirror_grad_.col(i)-= f;
+      mirror_grad_.col(j)+= f;
+    }
+  };
+  // Doubling counted pair of mirrors twice, and it counted no pair of two
+  // nodes that are their own mirrors.
+  for(int a= 0; a < mirror_pairs_; ++a) {
+    pair(mirror_order_[2 * a], mirror_order_[2 * a + 1], -1.0);
+  }
+  if(n - 2 * mirror_pairs_ == 2) {
+    pair(mirror_order_[n - 2], mirror_order_[n - 1], 1.0);
+  }
+  if(q & POTENTIAL) potential_= u;
+  telemetry_.finish(q, t0);
 }
 
 
-void minimizer::net_force_and_pot(Matrix3Xd const &pos) {
+void minimizer::net_force_and_pot_mirror(
+    Eigen::Ref<Matrix3Xd const> const &red, double *grad, quantities q) {
+  if((q & FORCES) && !grad) throw "null pointer to gradient";
+  mirror_expand(red);
+  if(gpu_ || options_.theta > 0.0) {
+    net_force_and_pot(mirror_pos_, mirror_grad_.data(), q);
+  } else {
+    mirror_evaluate(q);
+  }
+  if(!(q & FORCES)) return;
+  // Chain rule: position of mirror is reflection of representative's.
   int const m= graph_.modulus;
-  forces_= Eigen::MatrixXd::Zero(3 * m, m);
-  potential_= 0.0;
-  for(int i= 0; i < m; ++i) {
-    for(int j= i + 1; j < m; ++j) {
-      Vector3d const f= force_and_pot({i, j, pos.col(j) - pos.col(i)});
-      forces_.block(i * 3, j, 3, 1)= f;
-      forces_.block(j * 3, i, 3, 1)= -f;
+  Eigen::Map<Matrix3Xd> g(grad, 3, red.cols());
+  for(unsigned a= 0; a < mirror_reps_.size(); ++a) {
+    int const i= mirror_reps_[a];
+    int const j= (m - i) % m;
+    g.col(a)= mirror_grad_.col(i);
+    if(j == i) {
+      g(0, a)= 0.0;
+    } else {
+      g.col(a)+= reflect.cwiseProduct(mirror_grad_.col(j));
     }
   }
-  // OK to call force(unsigned) after this point.
-  net_forces_= forces_.rowwise().sum();
+}
+
+
+void minimizer::minimize_mirror() {
+  int const m= graph_.modulus;
+  Matrix3Xd red(3, mirror_reps_.size()); // Reduced positions.
+  for(unsigned a= 0; a < mirror_reps_.size(); ++a) {
+    int const i= mirror_reps_[a];
+    int const j= (m - i) % m;
+    // Symmetrize; node that is its own mirror lands in plane x = 0.
+    red.col(a)= 0.5 * (positions_.col(i) +
+                          reflect.cwiseProduct(positions_.col(j)));
+  }
+  minimize_gradient(red, true);
+  mirror_expand(red);
+  positions_= mirror_pos_;
+}
+
+
+void minimizer::warm_start(
+    Matrix3Xd const &pos, vector<char> const &changed) {
+  warm_start(pos);
+  if(int(changed.size()) != pos.cols()) throw "changed nodes of wrong size";
+  long const n= std::count(changed.begin(), changed.end(), char(0));
+  if(n == 0 || n == pos.cols() || options_.algorithm == NM_SIMPLEX) return;
+  held_.resize(changed.size());
+  for(unsigned i= 0; i < changed.size(); ++i) held_[i]= !changed[i];
+}
+
+
+layout_key minimizer::key() const {
+  return {graph_.modulus,
+      edge_attract_,
+      sum_attract_,
+      factor_attract_,
+      options_.theta};
 }
 
 
 void minimizer::go() {
-#ifdef NM_SIMPLEX
-  minimize_nm_simplex(positions_);
-#else
+  layout_key const key= this->key();
+  layout_cache const cache(options_.cache_dir);
+  bool const cached= !options_.cache_dir.empty() && !subset_;
+  if(cached && cache.load(key, positions_)) {
+    std::cout << "using cached layout" << std::endl;
+    iterations_= 0;
+    converged_= true;
+    return;
+  }
+  checkpoint c;
+  if(snapshots() && !options_.checkpoint_dir.empty() &&
+     checkpoint_dir(options_.checkpoint_dir).load(key, c)) {
+    std::cout << "resuming from checkpoint at iteration " << c.iterations
+              << std::endl;
+    positions_= c.positions;
+    resumed_= c.iterations;
+    resume_stage_= c.stage;
+    warm_= true;
+  } else if(cached && !warm_ && cache.load_nearest(key, positions_)) {
+    std::cout << "starting from nearest cached layout" << std::endl;
+    warm_= true;
+  }
+  stop_= telemetry::clock::time_point();
+  if(options_.deadline > 0.0) {
+    std::chrono::duration<double> const d(options_.deadline);
+    stop_= telemetry::clock::now() +
+           std::chrono::duration_cast<telemetry::clock::duration>(d);
+  }
+  base_= evaluations();
+  if(options_.starts > 1 && !subset_) {
+    race_starts();
+  } else {
+    minimize();
+  }
+  // Layout cut short by budget, unconverged, or converged only to coarser
+  // tolerance of single precision would be mistaken later for final one.
+  bool const coarse= (options_.precision == "float" && soa_forces_f_.size());
+  if(cached && converged_ && !spent_ && !coarse) {
+    cache.store(key, positions_);
+  }
+  if(snapshots() && !options_.checkpoint_dir.empty() && !spent_) {
+    checkpoint_dir(options_.checkpoint_dir).remove(key);
+  }
+}
+
+
+void minimizer::snapshot(
+    Eigen::Ref<Matrix3Xd const> const &x, int iter, bool mirror) {
+  if(!snapshots()) return;
+  int const k= done_ + iter; // Iterations over every stage.
+  int const every= options_.frame_every;
+  if(every > 0 && k % every == 0) {
+    // Variants of sweep, laid out concurrently, differ in hash of key.
+    char frame[16];
+    std::snprintf(frame, sizeof(frame), "-frame-%07d", k);
+    std::string const stem= key().stem() + frame;
+    if(mirror) {
+      mirror_expand(x);
+      graph_.write(mirror_pos_, stem, options_.format);
+    } else {
+      graph_.write(x, stem, options_.format);
+    }
+  }
+  int const ckpt= std::max(options_.checkpoint_every, 1);
+  if(k > 0 && k % ckpt == 0) save_checkpoint(x, iter, mirror);
+}
+
+
+void minimizer::save_checkpoint(
+    Eigen::Ref<Matrix3Xd const> const &x, int iter, bool mirror) {
+  if(!snapshots() || options_.checkpoint_dir.empty()) return;
+  checkpoint c;
+  c.key= key();
+  c.stage= (mirror ? 0 : 1);
+  c.iterations= done_ + iter;
+  if(mirror) {
+    mirror_expand(x);
+    c.positions= mirror_pos_;
+  } else {
+    c.positions= x;
+  }
+  checkpoint_dir(options_.checkpoint_dir).store(c);
+}
+
+
+void minimizer::minimize() {
+  cancelled_= false;
+  spent_= false;
+  // Iterations and stage before resumption from checkpoint are consumed.
+  done_= resumed_;
+  int const stage= resume_stage_;
+  resumed_= 0;
+  resume_stage_= 0;
+  if(options_.multilevel && !warm_ && !subset_) {
+    // Coarse levels get whatever remains of deadline and budget.
+    options o= options_;
+    if(stop_ != telemetry::clock::time_point()) {
+      std::chrono::duration<double> const d= stop_ - telemetry::clock::now();
+      o.deadline= std::max(d.count(), 1.0E-09);
+    }
+    if(o.budget > 0) o.budget-= evaluations() - base_;
+    int spent= 0; // Evaluations by coarse levels.
+    positions_= coarse_layout(graph_, o, spent);
+    base_-= spent;
+  }
+  if(!held_.empty()) {
+    // Local stage moves only changed nodes, against every other node.
+    if(options_.algorithm == NEWTON_CG) {
+      minimize_newton(positions_);
+    } else {
+      minimize_gradient(positions_);
+    }
+    held_.clear();
+    done_+= iterations_;
+    if(cancelled_ || spent_) {
+      iterations_= done_;
+      return;
+    }
+  }
+  if(options_.algorithm == NM_SIMPLEX) {
+    minimize_nm_simplex(positions_);
+    iterations_+= done_;
+    return;
+  }
+  if(options_.algorithm == NEWTON_CG) {
+    minimize_newton(positions_);
+    iterations_+= done_;
+    return;
+  }
+  if(!mirror_reps_.empty() && stage == 0) {
+    minimize_mirror();
+    done_+= iterations_;
+  }
+  if(cancelled_ || spent_) {
+    iterations_= done_;
+    return;
+  }
   minimize_gradient(positions_);
-#endif
+  iterations_+= done_;
+}
+
+
+void minimizer::race_starts() {
+  int const k= options_.starts;
+  race r(k, 100, options_.start_margin);
+  // Every rival is quiet and uncached; only kept layout is reported.  Rival
+  // is timed if start 0 be, so that final record of kept start be complete.
+  bool const timed=
+      (options_.progress_format != "none" || options_.on_progress);
+  std::vector<std::unique_ptr<minimizer>> rivals;
+  for(int s= 1; s < k; ++s) {
+    options o= options_;
+    o.starts= 1;
+    o.seed= options_.seed + s;
+    o.cache_dir.clear();
+    o.progress_format= "none";
+    o.on_progress= nullptr;
+    if(timed) o.on_progress= [](progress const &) {};
+    rivals.emplace_back(new minimizer(graph_, o));
+    rivals.back()->stop_= stop_; // Every start has same deadline.
+  }
+  vector<minimizer *> all({this});
+  for(auto &p: rivals) all.push_back(p.get());
+  vector<std::function<void()>> tasks;
+  for(minimizer *p: all) {
+    p->telemetry_.defer(); // Final record waits for choice of kept start.
+    p->checkpoint_= [&r](int iter, double f) { return r.check(iter, f); };
+    tasks.push_back([p, &r] {
+      try {
+        p->minimize();
+        // Compare potential at final positions of every start.
+        if(!p->cancelled_) {
+          p->net_force_and_pot(p->positions_, nullptr, POTENTIAL);
+        }
+      } catch(...) {
+        r.finish(p->iterations_, 0.0, false);
+        throw;
+      }
+      r.finish(p->iterations_, p->potential_, !p->cancelled_);
+    });
+  }
+  scheduler(k).run(std::move(tasks));
+  // Keep lowest potential; tie goes to earlier start.  Best start at each
+  // checkpoint is never cancelled; so some start always completes.
+  minimizer *best= nullptr;
+  int kept= 0, cancelled= 0;
+  for(int s= 0; s < k; ++s) {
+    minimizer const *p= all[s];
+    cancelled+= p->cancelled_;
+    if(p->cancelled_ || (best && p->potential_ >= best->potential_)) continue;
+    best= all[s];
+    kept= s;
+  }
+  checkpoint_= nullptr;
+  cancelled_= false;
+  if(best != this) {
+    positions_= best->positions_;
+    potential_= best->potential_;
+    iterations_= best->iterations_;
+    converged_= best->converged_;
+    spent_= best->spent_;
+  }
+  telemetry_.release(best->telemetry_);
+  std::cout << graph_.modulus << ": kept start " << kept << " of " << k
+            << " (f()=" << potential_ << "); cancelled " << cancelled
+            << std::endl;
 }
 
 
-MatrixXd minimizer::init_loc(unsigned m) {
+MatrixXd minimizer::init_loc(unsigned m, unsigned seed) {
+  // Private generator, seeded by number of nodes (and by seed of start),
+  // keeps initial locations reproducible even when several graphs be laid
+  // out concurrently.
+  std::seed_seq seq({m, seed});
+  std::mt19937 gen(m);
+  if(seed) gen.seed(seq);
+  std::uniform_real_distribution<double> uni(-0.5, 0.5);
   MatrixXd r(3, m); // Return-value.
   for(unsigned i= 0; i < m; ++i) {
-    constexpr double u= 1.0 / RAND_MAX;
-    r(0, i)= m * (rand() * u - 0.5);
-    r(1, i)= m * (rand() * u - 0.5);
-    r(2, i)= m * (rand() * u - 0.5);
+    r(0, i)= m * uni(gen);
+    r(1, i)= m * uni(gen);
+    r(2, i)= m * uni(gen);
   }
   return r;
 }
 
 
-minimizer::minimizer(graph &g): positions_(init_loc(g.modulus)), graph_(g) {}
+minimizer::minimizer(
+    squares const &g, options const &o, vector<int> const &nodes):
+    minimizer(g,
+        o,
+        springs(g, o.edge_attract, o.sum_attract, o.factor_attract, nodes),
+        !nodes.empty()) {}
+
+
+minimizer::minimizer(
+    squares const &g, spring_pattern const &p, options const &o):
+    minimizer(g,
+        o,
+        springs(p, o.edge_attract, o.sum_attract, o.factor_attract),
+        false) {}
+
+
+minimizer::minimizer(
+    squares const &g, options const &o, springs &&s, bool subset):
+    positions_(init_loc(s.k().rows(), o.seed)),
+    graph_(g),
+    options_(o),
+    telemetry_(g.modulus,
+        o.progress_format,
+        o.progress_path,
+        o.progress_every,
+        o.on_progress),
+    subset_(subset),
+    edge_attract_(o.edge_attract),
+    sum_attract_(o.sum_attract),
+    factor_attract_(o.factor_attract),
+    springs_(std::move(s)),
+    pool_(std::max(o.threads, 1)),
+    partial_grads_(pool_.size()),
+    soa_forces_(pool_.size()),
+    partial_pot_(pool_.size()) {
+  if(!known_precision(o.precision)) throw "unknown precision";
+  int const m= positions_.cols(); // Number of nodes laid out.
+  int const t= pool_.size();
+  for(int i= 1; i < t; ++i) partial_grads_[i].resize(3, m);
+  if(o.theta == 0.0) {
+    soa_positions_.resize(m, 3);
+    soa_direction_.resize(m, 3);
+    for(auto &s: soa_forces_) s.resize(m, 3);
+    if(o.precision != "double" && !o.gpu) {
+      soa_positions_f_.resize(m, 3);
+      soa_forces_f_.resize(t);
+      for(auto &s: soa_forces_f_) s.resize(m, 3);
+    }
+  }
+  auto const &k= springs_.k();
+  pair_tiles_= split_rows(m, t, [m](int i) { return m - 1 - i; });
+  node_tiles_= split_rows(m, t, [](int) { return 1; });
+  spring_tiles_= split_rows(m, t, [&k](int i) {
+    return k.outerIndexPtr()[i + 1] - k.outerIndexPtr()[i];
+  });
+  if(o.mirror && !subset_ && o.algorithm != NM_SIMPLEX &&
+      o.algorithm != NEWTON_CG) {
+    for(int i= 0; i <= m / 2; ++i) mirror_reps_.push_back(i);
+    for(int i= 1; i < m - i; ++i) {
+      mirror_order_.push_back(i);
+      mirror_order_.push_back(m - i);
+    }
+    mirror_pairs_= mirror_order_.size() / 2;
+    mirror_order_.push_back(0);
+    if(m % 2 == 0) mirror_order_.push_back(m / 2);
+    mirror_tiles_= split_rows(
+        mirror_pairs_, t, [m](int a) { return m - 1 - 2 * a; });
+    mirror_pos_.resize(3, m);
+    mirror_grad_.resize(3, m);
+  }
+  if(o.algorithm == NEWTON_CG && o.theta > 0.0) {
+    throw "Newton-CG requires exact repulsion";
+  }
+  if(o.gpu) {
+    if(o.theta > 0.0) throw "OpenCL-evaluation requires exact repulsion";
+    gpu_.reset(new opencl_evaluator(m, springs_));
+    std::cerr << "evaluating on " << gpu_->device_name() << std::endl;
+  }
+}
 
 
 } // namespace modgraph
@@ -1,56 +1,30 @@
 
 /// @file       minimizer.hpp
-///
-/// @brief      Definition of modgraph::node_pair; declaration of
-///             modgraph::minimizer.
-///
+/// @brief      Declaration of modgraph::minimizer.
 /// @copyright  2022 Thomas E. Vaughan, all rights reserved.
 
 #pragma once
 
+#include "layout-cache.hpp" // layout_key
+#include "octree.hpp" // octree
+#include "opencl-evaluator.hpp" // opencl_evaluator
+#include "options.hpp" // options
+#include "repulsion.hpp" // soa
+#include "springs.hpp" // springs
+#include "telemetry.hpp" // telemetry
+#include "thread-pool.hpp" // thread_pool
+#include <algorithm> // fill
 #include <eigen3/Eigen/Dense> // Matrix
+#include <functional> // function
 #include <gsl/gsl_multimin.h> // gsl_vector_view, gsl_vector_const_view
 #include <iostream> // cerr, endl
+#include <memory> // unique_ptr
 #include <vector> // vector
 
 namespace modgraph {
 
 
-class graph;
-
-
-/// Information relevant to calculation of force between pair of nodes.
-class node_pair {
-  int const i_; ///< Offset of one node.
-  int const j_; ///< Offset of other node.
-  double const r_; ///< Distance between Node i and Node j.
-  Eigen::Vector3d const u_; ///< Unit-vector from Node i to Node j.
-
-public:
-  /// Initialize offset of one node and other, distance between nodes, and
-  /// unit-vector from one toward other.
-  /// @param i  Offset of one node.
-  /// @param j  Offset of other node.
-  /// @param d  Displacement from one node to other.
-  node_pair(int const i, int const j, Eigen::Vector3d const &d):
-      i_(i), j_(j), r_(d.norm()), u_(d / r_) {}
-
-  /// Offset of one node.
-  /// @return  Offset of one node.
-  int i() const { return i_; }
-
-  /// Offset of other node.
-  /// @return  Offset of other node.
-  int j() const { return j_; }
-
-  /// Distance between nodes.
-  /// @return  Distance between nodes.
-  double r() const { return r_; }
-
-  /// Unit-vector from one node toward other.
-  /// @return  Unit-vector from one node toward other.
-  Eigen::Vector3d const &u() const { return u_; }
-};
+class squares;
 
 
 /// Facility for force-minimization via GSL of nodes in directed graph of
@@ -62,26 +36,69 @@ class minimizer {
   /// - Final values are copied from gsl back here after minimization.
   Eigen::Matrix3Xd positions_;
 
-  /// Reference to graph whose nodes are to be positioned by minimization.
-  graph &graph_;
+  /// Reference to tables of graph whose nodes are to be positioned by
+  /// minimization.
+  squares const &graph_;
 
-  /// 3NxN matrix storing force felt by each node from each other node.
-  /// - forces_ is initialized by net_force_and_pot().
-  Eigen::MatrixXd forces_;
+  /// Run-time options governing layout.
+  /// - Only seed is ever changed, by restart().
+  options options_;
 
-  /// 3Nx1 matrix storing net force felt by each node.
-  /// - net_forces_ is initialized by net_force_and_pot().
-  Eigen::MatrixXd net_forces_;
+  /// Octree used for approximate repulsion when options_.theta be nonzero.
+  octree octree_;
 
   /// Scalar potential whose gradient produces forces.
   /// - potential_ is calculated by net_force_and_pot().
   double potential_;
 
-  /// Compute force felt by Node i from Node j, and update potential_.
-  /// - force_and_pot() is called by net_force_and_pot().
-  /// @param np  Information needed to calculate force on one node from other.
-  /// @return  Force felt by Node i from Node j.
-  Eigen::Vector3d force_and_pot(node_pair const &np);
+  /// Reporter of progress, which also counts and times evaluations.
+  telemetry telemetry_;
+
+  int iterations_= 0; ///< Number of iterations of GSL's minimizer.
+  bool converged_= false; ///< True if last minimization converged.
+  bool warm_= false; ///< True if positions_ were set by warm_start().
+  bool cancelled_= false; ///< True if last minimization were cancelled.
+
+  /// True if last minimization stopped because deadline passed or budget
+  /// were spent.
+  bool spent_= false;
+
+  /// Time at which options_.deadline passes, or zero time if there be no
+  /// deadline; set by go().
+  telemetry::clock::time_point stop_;
+
+  /// Number of evaluations, counted by telemetry_, before current layout
+  /// began, less number of evaluations by earlier stages (like multilevel
+  /// levels) that used other minimizers; set by go().
+  int base_= 0;
+
+  /// Number of products with Hessian computed by hessian_times().
+  int products_= 0;
+
+  /// For each node, nonzero if node be held at its position during local
+  /// stage of incremental layout; empty unless warm_start() were given
+  /// changed nodes, and emptied by minimize() after local stage.
+  std::vector<char> held_;
+
+  /// Iterations before resumption from checkpoint; consumed by minimize().
+  int resumed_= 0;
+
+  /// Stage (0 for mirror-constrained, 1 for main) at which minimize()
+  /// begins; set on resumption from checkpoint.
+  int resume_stage_= 0;
+
+  /// Iterations of earlier stages (like mirror-constrained stage) of current
+  /// minimization.
+  int done_= 0;
+
+  /// Function called at top of every iteration with cumulative number of
+  /// iterations and current potential; minimization is cancelled when it
+  /// return false.  Empty unless start be racing other starts.
+  std::function<bool(int, double)> checkpoint_;
+
+  /// True if only subset of graph's nodes be laid out.
+  /// - Layout of subset is never cached and never multilevel.
+  bool const subset_;
 
   /// Scale of attraction of every Node `i` to each Nodes `j` whenever either
   /// `i` maps to `j`, or `j` maps to `i`; that is, whenever Node `i` and Node
@@ -91,7 +108,7 @@ class minimizer {
   ///   they be separated by unit distance.
   /// @return  Scale of attraction of every Node `i` to each Node `j` whenever
   ///          they are connected by a directed edge.
-  double edge_attract_= 1.5;
+  double const edge_attract_;
 
   /// Relative scale of attraction of every Node `i` to each Node `j` whenever
   /// `(i + j) % m` is either factor `f` of modulus `m` or `m - f`.
@@ -102,7 +119,7 @@ class minimizer {
   ///   whenever they be separated by unit distance.
   /// @return  Relative scale of attraction of every Node `i` to each Node `j`
   ///          whenever `(i + j) % m` is either `f` or `m - f`.
-  double sum_attract_= 15.0;
+  double const sum_attract_;
 
   /// Relative scale of attraction of every Node `i` to each Node `j` whenever
   /// `j` is either factor `f` of modulus `m` or `m - f`.
@@ -113,7 +130,109 @@ class minimizer {
   ///   whenever they be separated by unit distance.
   /// @return  Relative scale of attraction of every Node `i` to each Node `j`
   ///          whenever `j` is either `f` or `m` - `f`.
-  double factor_attract_= 150.0;
+  double const factor_attract_;
+
+  /// Sparse list of springs, built once from graph_ and from strengths of
+  /// attraction.
+  springs const springs_;
+
+  /// Threads that share each evaluation of forces and potential.
+  thread_pool pool_;
+
+  /// For thread t > 0, 3xN matrix accumulating gradient found by thread t.
+  /// - Thread 0 accumulates directly into caller's gradient.
+  /// - After every thread finishes, partial gradients are added into
+  ///   caller's gradient in order of thread-index, so that result is
+  ///   reproducible for given number of threads.
+  std::vector<Eigen::Matrix3Xd> partial_grads_;
+
+  /// Copy of positions as structure of arrays, for exact repulsion.
+  /// - soa_positions_ is refreshed by net_force_and_pot().
+  soa soa_positions_;
+
+  /// For each thread, forces from exact repulsion as structure of arrays.
+  /// - After thread finishes its rows, result is subtracted from thread's
+  ///   3xN accumulator of gradient.
+  std::vector<soa> soa_forces_;
+
+  /// Copy of direction as structure of arrays, for product of Hessian of
+  /// exact repulsion with direction.
+  /// - soa_direction_ is refreshed by hessian_times().
+  soa soa_direction_;
+
+  /// Copy of positions in single precision, used while single_ be true.
+  soa_f soa_positions_f_;
+
+  /// For each thread, forces in single precision, folded every few rows
+  /// into soa_forces_.
+  std::vector<soa_f> soa_forces_f_;
+
+  /// True while exact repulsion be computed in single precision.
+  bool single_= false;
+
+  /// For each thread, potential found by thread.
+  std::vector<double> partial_pot_;
+
+  /// First row of each thread's tile of pairwise repulsion; last element is
+  /// N.
+  /// - Rows are split so that every tile has nearly same number of pairs.
+  std::vector<int> pair_tiles_;
+
+  /// First node of each thread's tile of octree-repulsion; last element is N.
+  std::vector<int> node_tiles_;
+
+  /// First row of each thread's tile of springs_; last element is N.
+  /// - Rows are split so that every tile has nearly same number of springs.
+  std::vector<int> spring_tiles_;
+
+  /// Evaluator on OpenCL-device, or null if options_.gpu be false.
+  std::unique_ptr<opencl_evaluator> gpu_;
+
+  /// Deleter of GSL's workspace.
+  struct gsl_free {
+    /// Free workspace of gradient-method.
+    /// @param s  Pointer to workspace.
+    void operator()(gsl_multimin_fdfminimizer *s) const {
+      gsl_multimin_fdfminimizer_free(s);
+    }
+
+    /// Free workspace of simplex-method.
+    /// @param s  Pointer to workspace.
+    void operator()(gsl_multimin_fminimizer *s) const {
+      gsl_multimin_fminimizer_free(s);
+    }
+  };
+
+  /// Workspace of GSL's gradient-method, kept from one minimization to
+  /// next, and reallocated only when type or size change.
+  std::unique_ptr<gsl_multimin_fdfminimizer, gsl_free> fdf_workspace_;
+
+  /// Workspace of GSL's simplex-method, kept as fdf_workspace_ is.
+  std::unique_ptr<gsl_multimin_fminimizer, gsl_free> f_workspace_;
+
+  /// For mirror-constrained minimization, representative `i <= m - i` of
+  /// each pair of mirror-nodes; column `a` of reduced positions is position
+  /// of Node `mirror_reps_[a]`.
+  std::vector<int> mirror_reps_;
+
+  /// Full positions expanded from reduced positions.
+  Eigen::Matrix3Xd mirror_pos_;
+
+  /// Full gradient, before it be folded onto reduced coordinates.
+  Eigen::Matrix3Xd mirror_grad_;
+
+  /// Node in each row of soa_positions_ for mirror-constrained repulsion.
+  /// - First come pairs of rows, each representative that is not its own
+  ///   mirror followed by its mirror; nodes that are their own mirrors come
+  ///   last.
+  std::vector<int> mirror_order_;
+
+  /// Number of representatives that are not their own mirrors.
+  int mirror_pairs_= 0;
+
+  /// First representative of each thread's tile of mirror-constrained
+  /// repulsion; last element is mirror_pairs_.
+  std::vector<int> mirror_tiles_;
 
   // Minimize potential via simplex method not requiring forces.
   // - This is called by minimize().
@@ -122,62 +241,285 @@ class minimizer {
 
   // Minimize potential via gradient-method requiring forces.
   // - This is called by minimize().
+  /// @param positions  3xN matrix for position of each of N nodes, or 3xR
+  ///                   matrix of reduced positions if `mirror` be true.
+  /// @param mirror  True for mirror-constrained minimization.
+  void minimize_gradient(Eigen::Matrix3Xd &positions, bool mirror= false);
+
+  // Minimize potential via truncated-Newton method, whose each step is
+  // found by conjugate gradients with analytic products of Hessian.
+  // - This is called by minimize().
   /// @param positions  3xN matrix for position of each of N nodes.
-  void minimize_gradient(Eigen::Matrix3Xd &positions);
-
-  /// Calculate spring-force of attraction felt by one node from another, and
-  /// increment global potential.
-  /// @param k  Spring-constant.
-  /// @param np  Information needed to calculate force on one node from other.
-  /// @return  Force felt by one node from other.
-  Eigen::Vector3d attract(double k, node_pair const &np);
-
-  /// Calculate inverse-square-distance repulsive force between felt by one
-  /// node from other, and increment global potential.
-  /// @param np  Information needed to calculate force on one node from other.
-  /// @return  Force felt by one node from other.
-  Eigen::Vector3d repel(node_pair const &np);
-
-  /// Calculate spring-attraction force felt by Node i from Node j because of
-  /// directed graph-edge between them.
-  /// @param np  Information needed to calculate force on one node from other.
-  /// @return  Force felt by Node i.
-  Eigen::Vector3d edge_attract(node_pair const &np);
-
-  /// Calculate spring-attraction force felt by Node i from Node j either
-  /// because (i+j)%M==f, where f is factor of modulus M, or because
-  /// (i+j)%M==M-f.
-  /// @param np  Information needed to calculate force on one node from other.
-  /// @return  Force felt by Node i.
-  Eigen::Vector3d sum_attract(node_pair const &np);
-
-  /// Calculate spring-attraction force felt by Node i from Node j when either
-  /// i or j be factor of modulus or when either i or j be smaller than modulus
-  /// by factor of modulus.
-  /// - Attraction is usually proportional to factor but proportional to
-  ///   modulus itself (strongest) if i or j be zero.
-  /// @param np  Information needed to calculate force on one node from other.
-  /// @return  Force felt by Node i.
-  Eigen::Vector3d factor_attract(node_pair const &np);
+  void minimize_newton(Eigen::Matrix3Xd &positions);
+
+  /// Run every stage of minimization from positions_: multilevel start (if
+  /// enabled and not warm), mirror-constrained stage, and main stage.
+  /// - This is called by go() for single start and by race_starts() for
+  ///   each start.
+  void minimize();
+
+  /// Minimize from options_.starts independent starts concurrently, and
+  /// keep lowest potential.
+  /// - This is called by go().
+  void race_starts();
+
+  /// Minimize potential with mirror-nodes constrained to reflected
+  /// positions, starting from symmetrized positions_.
+  /// - This is called by go() before unconstrained minimization.
+  void minimize_mirror();
+
+  /// Expand reduced positions into mirror_pos_.
+  /// @param reduced  3xR matrix for position of each of R representatives.
+  void mirror_expand(Eigen::Ref<Eigen::Matrix3Xd const> const &reduced);
+
+  /// Subtract spring-force felt by each node attached by spring to any node
+  /// in rows [b, e) of springs_ from gradient.
+  /// - attract() is called by tile().
+  /// - Template-parameters P and F select computation of potential and of
+  ///   forces, so that work not needed is compiled out of loop over springs.
+  /// @param pos  3xN matrix for position of each of N nodes.
+  /// @param b  First row of springs_.
+  /// @param e  One past last row of springs_.
+  /// @param g  3xN matrix into which gradient is accumulated, if F be true.
+  /// @return  Potential stored in springs of rows [b, e), or zero if P be
+  ///          false.
+  template<bool P, bool F>
+  double attract(Eigen::Ref<Eigen::Matrix3Xd const> const &pos,
+      int b,
+      int e,
+      Eigen::Map<Eigen::Matrix3Xd> &g) const;
+
+  /// Compute gradient, potential, or both for thread t's share of every tile.
+  /// - tile() is called on every thread by net_force_and_pot().
+  /// @param pos  3xN matrix for position of each of N nodes.
+  /// @param grad  Storage for 3N components of gradient, used by thread 0.
+  /// @param t  Index of thread.
+  /// @param q  Quantities to compute.
+  void tile(Eigen::Ref<Eigen::Matrix3Xd const> const &pos,
+      double *grad,
+      int t,
+      quantities q);
+
+  /// Key of layout, for cache and for checkpoints and frames.
+  /// @return  Modulus and parameters of potential.
+  layout_key key() const;
+
+  /// True if frames and checkpoints be written for this minimizer.
+  /// - Neither is written for subset or for any of several starts.
+  /// @return  True if either frames or checkpoints be enabled.
+  bool snapshots() const {
+    return !subset_ && options_.starts == 1 &&
+           (options_.frame_every > 0 || !options_.checkpoint_dir.empty());
+  }
+
+  /// Write frame, checkpoint, or both of current iterate, when due.
+  /// - snapshot() is called at top of every iteration of every method.
+  /// @param x  3xN matrix of current positions, or 3xR matrix of reduced
+  ///           positions if `mirror` be true.
+  /// @param iter  Number of iterations of current stage so far.
+  /// @param mirror  True in mirror-constrained stage.
+  void snapshot(
+      Eigen::Ref<Eigen::Matrix3Xd const> const &x, int iter, bool mirror);
+
+  /// Write checkpoint of current iterate, regardless of cadence.
+  /// - save_checkpoint() is called by snapshot() and when deadline or
+  ///   budget run out.
+  /// @param x  3xN matrix of current positions, or 3xR matrix of reduced
+  ///           positions if `mirror` be true.
+  /// @param iter  Number of iterations of current stage so far.
+  /// @param mirror  True in mirror-constrained stage.
+  void save_checkpoint(
+      Eigen::Ref<Eigen::Matrix3Xd const> const &x, int iter, bool mirror);
+
+  /// Zero gradient (or product of Hessian) of every held node, so that no
+  /// method moves it.
+  /// @param g  Storage for 3N components.
+  void hold(double *g) const {
+    for(unsigned i= 0; i < held_.size(); ++i) {
+      if(held_[i]) std::fill(g + 3 * i, g + 3 * i + 3, 0.0);
+    }
+  }
+
+  /// Compute thread t's share of product of Hessian with direction.
+  /// - hess_tile() is called on every thread by hessian_times().
+  /// @param v  3xN matrix for direction at each of N nodes.
+  /// @param hv  Storage for 3N components of product, used by thread 0.
+  /// @param t  Index of thread.
+  void hess_tile(
+      Eigen::Ref<Eigen::Matrix3Xd const> const &v, double *hv, int t);
+
+  /// Compute gradient, potential, or both for thread t's share of
+  /// mirror-constrained evaluation.
+  /// - Each row 2a of soa_positions_ (or of soa_positions_f_) repels every
+  ///   later row, so that thread's tile covers one pair of each orbit under
+  ///   mirror-map; result is weighted by two as `2 T` in
+  ///   mirror_evaluate().
+  /// - mirror_tile() is called on every thread by mirror_evaluate().
+  /// @param t  Index of thread.
+  /// @param q  Quantities to compute.
+  void mirror_tile(int t, quantities q);
+
+  /// Compute potential and full gradient (in mirror_grad_) at mirror_pos_,
+  /// by exact repulsion over about N^2/4 pairs instead of N^2/2.
+  /// - Each distance is invariant under mirror-map; so sum over pairs is
+  ///   `2 T - sum of 1/r for (a, m - a) + 1/r between self-mirrors`, where
+  ///   `T` sums over pairs (a, j) for representative `a` before `j` in
+  ///   mirror_order_.
+  /// - Springs, which are not symmetric, are all evaluated.
+  /// @param q  Quantities to compute.
+  void mirror_evaluate(quantities q);
+
+  /// Repel exactly in single precision by rows b, b + stride, ... (before e)
+  /// of thread t's tile.
+  /// - repel_tile_f() is called by tile() and by mirror_tile() while single_
+  ///   be true.
+  /// @param t  Index of thread.
+  /// @param b  First row.
+  /// @param e  Row past last.
+  /// @param stride  Distance between rows.
+  /// @param q  Quantities to compute.
+  /// @return  Sum of 1/r over every pair in tile, or zero if `q` be FORCES.
+  double repel_tile_f(int t, int b, int e, int stride, quantities q);
+
+  /// True if deadline have passed or budget of evaluations be spent.
+  /// - out_of_budget() is checked at top of every iteration of every
+  ///   method.
+  /// @return  True if minimization should stop.
+  bool out_of_budget() const {
+    if(options_.budget > 0 && evaluations() - base_ >= options_.budget) {
+      return true;
+    }
+    return stop_ != telemetry::clock::time_point() &&
+           telemetry::clock::now() >= stop_;
+  }
 
   /// Generate random locations for initialization of positions_.
+  /// - Locations depend only on `n` and on `seed`, not on any global state.
   /// @param n  Number of locations.
+  /// @param seed  Seed; zero gives locations seeded by `n` alone.
   /// @return   Collection of random locations.
-  static Eigen::MatrixXd init_loc(unsigned n);
+  static Eigen::MatrixXd init_loc(unsigned n, unsigned seed);
+
+  /// Initialize module for graph of squares with its springs.
+  /// - This is called by each public constructor.
+  /// @param g  Reference to tables of graph whose nodes are to be positioned.
+  /// @param o  Run-time options governing layout.
+  /// @param s  Springs among nodes to be positioned.
+  /// @param subset  True if only subset of nodes be positioned.
+  minimizer(squares const &g, options const &o, springs &&s, bool subset);
 
 public:
-  /// Initialize moduls for graph of squares.
-  /// @param g  Reference to graph whose nodes are to be positioned.
-  minimizer(graph &g);
+  /// Initialize module for graph of squares.
+  /// @param g  Reference to tables of graph whose nodes are to be positioned.
+  /// @param o  Run-time options governing layout.
+  /// @param nodes  Subset of nodes to be positioned, in increasing order, or
+  ///               empty (default) for every node; column `a` of
+  ///               positions() is then position of Node `nodes[a]`.
+  minimizer(squares const &g,
+      options const &o,
+      std::vector<int> const &nodes= {});
+
+  /// Initialize module for graph of squares, with springs rescaled from
+  /// pattern shared by several minimizers (as by variants of sweep).
+  /// @param g  Reference to tables of graph whose nodes are to be positioned.
+  /// @param p  Pattern of springs for `g`.
+  /// @param o  Run-time options governing layout.
+  minimizer(squares const &g, spring_pattern const &p, options const &o);
 
   /// Compute net force felt by each node from every other node, and compute
   /// overall potential of system.
-  /// - Argument is reference to gsl's own working copy of positions.
+  /// - `positions` typically maps gsl's own working copy of positions, and
+  ///   `grad` typically points to gsl's own gradient; neither is copied.
+  /// - Gradient written is *negative* of net force on each node.
+  /// - If `q` be POTENTIAL, then no force is computed, and `grad` is left
+  ///   unchanged; if `q` be FORCES, then potential() is left unchanged.
+  ///   Either saves work when GSL needs only one of the two.
+  /// @param positions  3xN matrix for position of each of N particles.
+  /// @param grad  Storage for 3N components of gradient, in same order as
+  ///              `positions`; may be null if `q` be POTENTIAL.
+  /// @param q  Quantities to compute.
+  void net_force_and_pot(
+      Eigen::Ref<Eigen::Matrix3Xd const> const &positions,
+      double *grad,
+      quantities q= BOTH);
+
+  /// Compute product of Hessian of potential with direction, without
+  /// forming Hessian.
+  /// - Springs are quadratic; so their share of product is their gradient
+  ///   evaluated at `v`, found via same sparse list as for forces.
+  /// - Share of exact repulsion is found row by row via hess_row().
+  /// - Requires exact repulsion (zero theta); product is always computed on
+  ///   CPU in double precision.
   /// @param positions  3xN matrix for position of each of N particles.
-  void net_force_and_pot(Eigen::Matrix3Xd const &positions);
+  /// @param v  3xN matrix for direction at each of N particles.
+  /// @param hv  Storage for 3N components of product, in same order as `v`.
+  void hessian_times(Eigen::Ref<Eigen::Matrix3Xd const> const &positions,
+      Eigen::Ref<Eigen::Matrix3Xd const> const &v,
+      double *hv);
+
+  /// Replace random initial positions by given positions, typically final
+  /// positions of layout with nearby parameters.
+  /// - go() then ignores nearest cached layout, though not identical one.
+  /// @param pos  3xN matrix for position of each of N nodes.
+  void warm_start(Eigen::Matrix3Xd const &pos) {
+    if(pos.cols() != positions_.cols()) throw "warm start of wrong size";
+    positions_= pos;
+    warm_= true;
+    held_.clear();
+  }
+
+  /// Replace random initial positions by given positions, and relax changed
+  /// nodes first, with every other node held in place.
+  /// - Incremental layout (see incremental.hpp) starts this way; after the
+  ///   local stage, go() minimizes over every node, from near minimum.
+  /// - Local stage is skipped if every node or no node be changed, and for
+  ///   simplex, which uses no gradient.
+  /// @param pos  3xN matrix for position of each of N nodes.
+  /// @param changed  For each node, nonzero if its springs changed or if it
+  ///                 were new.
+  void warm_start(
+      Eigen::Matrix3Xd const &pos, std::vector<char> const &changed);
+
+  /// Seed of random initial positions.
+  /// @return  Seed, as for options::seed.
+  unsigned seed() const { return options_.seed; }
+
+  /// Spring-constants of every attracted pair.
+  /// @return  Sparse matrix of springs_.
+  springs::matrix const &spring_constants() const { return springs_.k(); }
+
+  /// Discard layout, and draw new random initial positions from seed, so
+  /// that go() minimizes again, while every table, buffer, and workspace is
+  /// kept.
+  /// - Long-running service restarts minimizer of cached graph this way.
+  /// @param seed  Seed of initial positions, as for options::seed.
+  void restart(unsigned seed) {
+    options_.seed= seed;
+    positions_= init_loc(positions_.cols(), seed);
+    warm_= false;
+    held_.clear();
+  }
+
+  /// Compute potential and reduced gradient for mirror-constrained
+  /// positions.
+  /// - Full positions are expanded from `reduced`, every force is computed
+  ///   (by mirror_evaluate() for exact repulsion on CPU, or else by
+  ///   net_force_and_pot()), and gradient of each member of mirror-pair is
+  ///   folded onto pair's representative.
+  /// @param reduced  3xR matrix for position of each of R representatives.
+  /// @param grad  Storage for 3R components of reduced gradient; may be null
+  ///              if `q` be POTENTIAL.
+  /// @param q  Quantities to compute.
+  void net_force_and_pot_mirror(
+      Eigen::Ref<Eigen::Matrix3Xd const> const &reduced,
+      double *grad,
+      quantities q= BOTH);
 
   /// Copy initial `positions` into gsl; drive gsl's minimizer; and
   /// then copy final values from gsl back into `positions`.
+  /// - If options name cache-directory, then cached layout is used instead
+  ///   of minimization or as starting point for minimization, and final
+  ///   positions are stored in cache.
   void go();
 
   /// Scalar potential whose gradient produces forces.
@@ -185,9 +527,35 @@ public:
   /// @return  Scalar potential whose gradient produces forces.
   double potential() const { return potential_; }
 
-  /// (i % 3)th component of net-force on (i / 3)th node.
-  /// @return  (i % 3)th component of net-force on (i / 3)th node.
-  double net_force_component(int i) const { return net_forces_(i, 0); }
+  /// Number of evaluations of potential, forces, or both so far.
+  /// - Each product with Hessian counts as one evaluation, for it costs
+  ///   about as much as evaluation of forces.
+  /// @return  Number of calls to net_force_and_pot() and hessian_times().
+  int evaluations() const {
+    return telemetry_.calls(POTENTIAL) + telemetry_.calls(FORCES) +
+           telemetry_.calls(BOTH) + products_;
+  }
+
+  /// Number of iterations of GSL's minimizer performed by go().
+  /// @return  Number of iterations, or zero if cached layout were used.
+  int iterations() const { return iterations_; }
+
+  /// True if precision be known.
+  /// @param name  Name of precision.
+  /// @return  True for "double", "float", or "mixed".
+  static bool known_precision(std::string const &name) {
+    return name == "double" || name == "float" || name == "mixed";
+  }
+
+  /// Whether go() stopped early because deadline passed or budget were
+  /// spent.
+  /// - Positions are then best found so far, and converged() is false.
+  /// @return  True if deadline passed or budget were spent.
+  bool budget_spent() const { return spent_; }
+
+  /// Whether go() reached minimum within tolerance.
+  /// @return  True if minimization converged or cached layout were used.
+  bool converged() const { return converged_; }
 
   /// Scale of attraction of every Node `i` to each Nodes `j` whenever either
   /// `i` maps to `j`, or `j` maps to `i`; that is, whenever Node `i` and Node
@@ -1,21 +1,280 @@
 
+#include "archive.hpp"
 #include "graph.hpp"
+#include "gsl-funcs.hpp"
+#include "layout.hpp"
+#include "scheduler.hpp"
+#include "service.hpp"
+#include "sweep.hpp"
+#include <algorithm> // sort, unique
+#include <climits> // INT_MAX
+#include <cstdint> // int64_t
+#include <functional> // greater
 #include <iostream> // cerr
+#include <memory> // unique_ptr
+#include <stdexcept> // exception
+#include <string> // to_string
+#include <unistd.h> // getopt(), optarg, optind
 
 using namespace modgraph;
 using namespace std;
 
+static char const usage[] =
+   "usage: modgraph [-a theta] [-t threads] [-j jobs] [-C cache-dir]\n"
+   "                [-m algorithm] [-s step] [-l line-tol] [-g tol]\n"
+   "                [-f asy|ply] [-P text|csv|json|none] [-p every]\n"
+   "                [-L progress-file] [-G] [-F double|float|mixed]\n"
+   "                [-E edge] [-S sum] [-K factor] [-M] [-Y]\n"
+   "                [-R starts] [-r margin] [-d seed] [-T seconds]\n"
+   "                [-B evaluations] [-c checkpoint-dir] [-e every]\n"
+   "                [-k every] [-A archive] moduli...\n"
+   "       modgraph [options] -D | -U socket [-Q capacity] [-I]\n"
+   "  moduli: list like '33', '2-5000', or '7,10-20,33'\n"
+   "  algorithm: vector_bfgs2 (default), vector_bfgs, conjugate_pr,\n"
+   "             conjugate_fr, steepest_descent, nmsimplex2, or\n"
+   "             newton_cg (truncated Newton; needs exact repulsion)\n"
+   "  edge, sum, factor: scales of attraction (default 1.5, 15, 150);\n"
+   "                     zero disables; comma-separated list of any sweeps\n"
+   "                     every combination for single modulus\n"
+   "  -D: serve requests on stdin; -U: on Unix-domain socket";
+
+/// Parse whole of `s` as value.
+/// @param s  Text to parse.
+/// @param v  On successful return, value.
+/// @return  False if `s` be malformed.
+template <typename T> static bool parse(char const *s, T &v)
+{
+   istringstream is(s);
+   return (is >> v) && (is >> ws).eof();
+}
+
+/// Parse comma-separated list of nonnegative values.
+/// @param s  Text to parse.
+/// @param v  On successful return, values.
+/// @return  False if `s` be malformed.
+static bool parse_scales(char const *s, vector<double> &v)
+{
+   istringstream iss(s);
+   string item;
+   v.clear();
+   while (getline(iss, item, ',')) {
+      double x;
+      if (!parse(item.c_str(), x) || x < 0.0) return false;
+      v.push_back(x);
+   }
+   return !v.empty();
+}
+
+/// Append to `list` every modulus in `spec`.
+/// - Every modulus must lie in [2, INT_MAX].
+/// @param spec  Comma-separated list of moduli and of ranges 'first-last'.
+/// @param list  Reference to list of moduli.
+/// @return  False if `spec` be malformed.
+static bool parse_moduli(char const *spec, vector<unsigned> &list)
+{
+   istringstream iss(spec);
+   string item;
+   while (getline(iss, item, ',')) {
+      istringstream is(item);
+      // Signed and wide, so that '-3' and '4294967296' are read as such
+      // rather than wrapped.
+      int64_t first, last;
+      char dash;
+      if (!(is >> first) || first < 2 || first > INT_MAX) return false;
+      last = first;
+      if (is >> dash && (dash != '-' || !(is >> last) || last < first ||
+                         last > INT_MAX)) {
+         return false;
+      }
+      if (!is.eof() && !(is >> ws).eof()) return false;
+      // Counter is wider than every modulus; so loop cannot wrap.
+      for (int64_t m = first; m <= last; ++m) list.push_back(unsigned(m));
+   }
+   return true;
+}
+
 int main(int argc, char** argv)
 {
-   if (argc != 2) {
-      cerr << "need exactly one argument" << endl;
+   options opts;
+   int jobs = 1;
+   bool daemon = false; // True if requests be served on stdin.
+   string socket_path; // Unix-domain socket of service, if any.
+   unsigned capacity = 8; // Largest number of graphs cached by service.
+   vector<double> edge{opts.edge_attract};
+   vector<double> sum{opts.sum_attract};
+   vector<double> factor{opts.factor_attract};
+   char const optstring[] =
+      "a:t:j:C:m:s:l:g:f:P:p:L:GF:E:S:K:MYR:r:d:DU:Q:T:B:c:e:k:A:I";
+   int c;
+   while ((c = getopt(argc, argv, optstring)) != -1) {
+      bool ok = true;
+      switch (c) {
+      case 'a': ok = parse(optarg, opts.theta) && opts.theta >= 0.0; break;
+      case 't': ok = parse(optarg, opts.threads) && opts.threads > 0; break;
+      case 'j': ok = parse(optarg, jobs) && jobs > 0; break;
+      case 'C': opts.cache_dir = optarg; break;
+      case 'm':
+         opts.algorithm = optarg;
+         ok = known_algorithm(opts.algorithm);
+         break;
+      case 's': ok = parse(optarg, opts.step) && opts.step >= 0.0; break;
+      case 'l':
+         ok = parse(optarg, opts.line_tol) && opts.line_tol > 0.0;
+         break;
+      case 'g': ok = parse(optarg, opts.tol) && opts.tol >= 0.0; break;
+      case 'f':
+         opts.format = optarg;
+         ok = opts.format == "asy" || opts.format == "ply";
+         break;
+      case 'P':
+         opts.progress_format = optarg;
+         ok = telemetry::known_format(opts.progress_format);
+         break;
+      case 'p':
+         ok = parse(optarg, opts.progress_every) && opts.progress_every > 0;
+         break;
+      case 'L': opts.progress_path = optarg; break;
+      case 'G': opts.gpu = true; break;
+      case 'M': opts.multilevel = true; break;
+      case 'Y': opts.mirror = true; break;
+      case 'R': ok = parse(optarg, opts.starts) && opts.starts > 0; break;
+      case 'r':
+         ok = parse(optarg, opts.start_margin) && opts.start_margin >= 0.0;
+         break;
+      case 'd': ok = parse(optarg, opts.seed); break;
+      case 'D': daemon = true; break;
+      case 'U': socket_path = optarg; break;
+      case 'Q': ok = parse(optarg, capacity) && capacity > 0; break;
+      case 'T':
+         ok = parse(optarg, opts.deadline) && opts.deadline >= 0.0;
+         break;
+      case 'B': ok = parse(optarg, opts.budget) && opts.budget >= 0; break;
+      case 'c': opts.checkpoint_dir = optarg; break;
+      case 'A': opts.archive = optarg; break;
+      case 'I': opts.incremental = true; break;
+      case 'e':
+         ok = parse(optarg, opts.checkpoint_every) &&
+              opts.checkpoint_every > 0;
+         break;
+      case 'k':
+         ok = parse(optarg, opts.frame_every) && opts.frame_every >= 0;
+         break;
+      case 'E': ok = parse_scales(optarg, edge); break;
+      case 'S': ok = parse_scales(optarg, sum); break;
+      case 'K': ok = parse_scales(optarg, factor); break;
+      case 'F':
+         opts.precision = optarg;
+         ok = minimizer::known_precision(opts.precision);
+         break;
+      default:
+         cerr << usage << endl;
+         return 1;
+      }
+      if (!ok) {
+         cerr << "illegal argument '" << optarg << "' for -" << char(c)
+              << endl;
+         return 1;
+      }
+   }
+   if (opts.algorithm == NEWTON_CG && opts.theta > 0.0) {
+      cerr << "newton_cg requires exact repulsion; omit -a" << endl;
+      return 1;
+   }
+   if (opts.gpu && opts.theta > 0.0) {
+      cerr << "-G requires exact repulsion; omit -a" << endl;
+      return 1;
+   }
+   opts.edge_attract = edge[0];
+   opts.sum_attract = sum[0];
+   opts.factor_attract = factor[0];
+   if (daemon || !socket_path.empty()) {
+      try {
+         service svc(opts, capacity);
+         if (socket_path.empty()) {
+            svc.serve_stdin();
+         } else {
+            svc.serve_socket(socket_path);
+         }
+      } catch (char const *e) {
+         cerr << "service: " << e << endl;
+         return 1;
+      } catch (exception const &e) {
+         cerr << "service: " << e.what() << endl;
+         return 1;
+      }
+      return 0;
+   }
+   if (argc - optind < 1) {
+      cerr << "need at least one modulus" << endl << usage << endl;
       return 1;
    }
-   istringstream iss(argv[1]);
-   unsigned m;
-   iss >> m;
-   cout << "contructing graph" << endl;
-   graph g(m);
+   vector<unsigned> moduli;
+   for (int i = optind; i < argc; ++i) {
+      if (!parse_moduli(argv[i], moduli)) {
+         cerr << "illegal moduli '" << argv[i] << "'" << endl;
+         return 1;
+      }
+   }
+   vector<strengths> const variants = grid(edge, sum, factor);
+   if (variants.size() > 1) {
+      if (moduli.size() != 1) {
+         cerr << "sweep needs exactly one modulus" << endl;
+         return 1;
+      }
+      if (!opts.archive.empty()) {
+         cerr << "sweep cannot write archive; omit -A" << endl;
+         return 1;
+      }
+      try {
+         // Tables of graph are built once and shared by every variant.
+         squares const g(moduli[0]);
+         cout << "sweeping " << variants.size() << " variant(s)" << endl;
+         sweep(g, opts, variants, jobs);
+      } catch (char const *e) {
+         cerr << "modulus " << moduli[0] << ": " << e << endl;
+         return 1;
+      }
+      return 0;
+   }
+   // Lay out largest moduli first, so that small ones fill in tail of run.
+   sort(moduli.begin(), moduli.end(), greater<unsigned>());
+   moduli.erase(unique(moduli.begin(), moduli.end()), moduli.end());
+   unique_ptr<archive_writer> archive;
+   if (!opts.archive.empty()) {
+      try {
+         layout_key const k{0, opts.edge_attract, opts.sum_attract,
+                            opts.factor_attract, opts.theta};
+         int const cap = max<int>(moduli[0] + 1,
+                                  archive_writer::DEFAULT_CAPACITY);
+         archive.reset(new archive_writer(opts.archive, k, cap));
+      } catch (char const *e) {
+         cerr << opts.archive << ": " << e << endl;
+         return 1;
+      }
+      if (int(moduli[0]) >= archive->capacity()) {
+         cerr << opts.archive << ": modulus " << moduli[0]
+              << " beyond index of archive" << endl;
+         return 1;
+      }
+   }
+   vector<function<void()>> tasks;
+   for (unsigned m : moduli) {
+      tasks.push_back([m, &opts, &archive] {
+         try {
+            layout_result const r = layout(m, opts);
+            if (archive) {
+               archive->append(r);
+            } else {
+               write_scene(r, to_string(m), opts.format);
+            }
+         } catch (char const *e) {
+            cerr << "modulus " << m << ": " << e << endl;
+         }
+      });
+   }
+   cout << "contructing " << moduli.size() << " graph(s)" << endl;
+   scheduler(jobs).run(move(tasks));
    return 0;
 }
 
+
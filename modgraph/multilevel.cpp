@@ -0,0 +1,122 @@
+/// @file       multilevel.cpp
+/// @brief      Definition of modgraph::tree_heights() and
+///             modgraph::coarse_layout().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "multilevel.hpp"
+#include "graph.hpp" // squares
+#include <algorithm> // max
+#include <chrono> // duration, duration_cast
+#include <iostream> // cout, endl
+#include <limits> // numeric_limits
+#include <random> // mt19937, normal_distribution
+
+using Eigen::Matrix3Xd;
+using Eigen::Vector3d;
+using std::vector;
+
+
+namespace modgraph {
+
+
+vector<int> tree_heights(squares const &g) {
+  int const m= g.modulus;
+  vector<int> h(m, std::numeric_limits<int>::max()); // Return-value.
+  vector<int> in(m); // Predecessors not yet peeled.
+  vector<int> leaves; // Nodes of current height.
+  for(int i= 0; i < m; ++i) {
+    in[i]= g.predecessors(i).size();
+    if(in[i] == 0) leaves.push_back(i);
+  }
+  // Peel every leaf; successor whose last predecessor be peeled is leaf of
+  // next height.  Node on cycle always keeps its predecessor on cycle.
+  vector<int> next;
+  for(int r= 0; !leaves.empty(); ++r) {
+    next.clear();
+    for(int i: leaves) {
+      h[i]= r;
+      if(--in[g.next(i)] == 0) next.push_back(g.next(i));
+    }
+    leaves.swap(next);
+  }
+  return h;
+}
+
+
+Matrix3Xd coarse_layout(
+    squares const &g, options const &o, int &evaluations) {
+  using clock= telemetry::clock;
+  std::chrono::duration<double> const deadline(o.deadline);
+  clock::time_point const stop=
+      clock::now() + std::chrono::duration_cast<clock::duration>(deadline);
+  evaluations= 0;
+  int const m= g.modulus;
+  vector<int> const h= tree_heights(g);
+  int const cycle= std::numeric_limits<int>::max();
+  int top= 0; // One more than greatest height off cycle.
+  for(int x: h) {
+    if(x != cycle) top= std::max(top, x + 1);
+  }
+  // Each level is minimized without cache and quietly.  Full tolerance is
+  // kept, because coarse level is cheap, while looser tolerance leaves more
+  // work (sometimes much more) for finest level.
+  options lo= o;
+  lo.multilevel= false;
+  lo.cache_dir.clear();
+  lo.progress_format= "none";
+  lo.on_progress= nullptr;
+  // Private generator keeps placement reproducible.
+  std::seed_seq seq({unsigned(m), o.seed});
+  std::mt19937 gen(m);
+  if(o.seed) gen.seed(seq);
+  std::normal_distribution<double> normal;
+  Matrix3Xd r= Matrix3Xd::Zero(3, m); // Return-value.
+  vector<int> nodes; // Nodes of current level.
+  for(int level= top; level >= 0; --level) {
+    // Place every node new to this level near its successor, which belongs
+    // to coarser level.
+    bool const coarsest= nodes.empty();
+    vector<int> finer;
+    for(int i= 0; i < m; ++i) {
+      if(h[i] < level) continue;
+      finer.push_back(i);
+      if(coarsest || h[i] != level) continue;
+      Vector3d d(normal(gen), normal(gen), normal(gen));
+      r.col(i)= r.col(g.next(i)) + d.normalized();
+    }
+    nodes.swap(finer);
+    // Leaves are refined by caller; but coarsest level is laid out even if
+    // it be level 0 (as when every node lies on cycle, like for m = 2).
+    if(level == 0 && !coarsest) break;
+    bool spent= false; // True if deadline or budget ran out.
+    if(o.deadline > 0.0) {
+      std::chrono::duration<double> const left= stop - clock::now();
+      spent= (left.count() <= 0.0);
+      lo.deadline= std::max(left.count(), 1.0E-09);
+    }
+    if(o.budget > 0) {
+      spent= spent || evaluations >= o.budget;
+      lo.budget= std::max(o.budget - evaluations, 1);
+    }
+    // Coarsest level is always laid out, if only to draw random positions.
+    if(spent && !coarsest) continue;
+    minimizer mz(g, lo, nodes);
+    int const n= nodes.size();
+    if(!coarsest) {
+      Matrix3Xd start(3, n);
+      for(int a= 0; a < n; ++a) start.col(a)= r.col(nodes[a]);
+      mz.warm_start(start);
+    }
+    mz.go();
+    for(int a= 0; a < n; ++a) r.col(nodes[a])= mz.positions().col(a);
+    evaluations+= mz.evaluations();
+    std::cout << m << ": level " << level << " of " << n << " nodes in "
+              << mz.iterations() << " iterations" << std::endl;
+  }
+  return r;
+}
+
+
+} // namespace modgraph
+
+// EOF
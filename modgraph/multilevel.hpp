@@ -0,0 +1,51 @@
+/// @file       multilevel.hpp
+/// @brief      Declaration of modgraph::tree_heights() and
+///             modgraph::coarse_layout().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+///
+/// Every node of squaring map has exactly one successor; so each component
+/// of graph is cycle with trees hanging off it.  Peeling every leaf, level by
+/// level, leaves only cycles, and that hierarchy guides multilevel layout.
+
+#pragma once
+
+#include "options.hpp" // options
+#include <eigen3/Eigen/Core> // Matrix3Xd
+#include <vector> // vector
+
+namespace modgraph {
+
+
+class squares;
+
+
+/// Height of every node in forest hanging off cycles.
+/// - Leaf (node without predecessor) has height 0; every other node off
+///   cycle has height one more than that of its highest predecessor.
+/// - Node on cycle has height of std::numeric_limits<int>::max().
+/// @param g  Tables of graph.
+/// @return  Height of each node.
+std::vector<int> tree_heights(squares const &g);
+
+
+/// Starting positions for full layout, found by multilevel refinement.
+/// - Coarsest level holds only nodes on cycles, and is minimized from random
+///   positions.
+/// - Each finer level adds every node of next lower height, placed at unit
+///   distance in random direction from its successor, and is minimized from
+///   there.
+/// - Leaves are placed near their successors but are not minimized here;
+///   caller's minimization of every node refines them.
+/// - Levels share deadline and budget of `o`; once either run out, every
+///   remaining level is placed but not minimized.
+/// @param g  Tables of graph.
+/// @param o  Options of full layout.
+/// @param evaluations  On return, number of evaluations by every level.
+/// @return  3xN matrix for position of each of N nodes.
+Eigen::Matrix3Xd coarse_layout(
+    squares const &g, options const &o, int &evaluations);
+
+
+} // namespace modgraph
+
+// EOF
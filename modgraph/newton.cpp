@@ -0,0 +1,127 @@
+/// @file       newton.cpp
+/// @brief      Definition of modgraph::minimizer::minimize_newton().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "minimizer.hpp"
+#include <algorithm> // min
+#include <cmath> // sqrt
+#include <gsl/gsl_errno.h> // GSL_SUCCESS, GSL_CONTINUE, GSL_ENOPROG
+
+using Eigen::Matrix3Xd;
+using std::cerr;
+using std::endl;
+
+
+namespace modgraph {
+
+
+/// Dot-product of two 3xN matrices, each regarded as vector of 3N
+/// components.
+/// @param a  First matrix.
+/// @param b  Second matrix.
+/// @return  Sum over components of product.
+static double dot(Matrix3Xd const &a, Matrix3Xd const &b) {
+  return (a.array() * b.array()).sum();
+}
+
+
+void minimizer::minimize_newton(Matrix3Xd &x) {
+  constexpr int MAX_ITER= 100000;
+  // Largest number of conjugate-gradient steps toward each Newton-step.
+  constexpr int MAX_CG= 500;
+  // Largest number of times that trial-step is halved by line-search.
+  constexpr int MAX_HALVINGS= 60;
+  // Fraction of decrease predicted by slope that trial-step must achieve.
+  constexpr double ARMIJO= 1.0E-04;
+  int const n= x.cols();
+  double const tol= (options_.tol > 0.0 ? options_.tol : 1.0E-05);
+  // Largest displacement of any step, as for first trial-step of GSL.
+  double const step= (options_.step > 0.0 ? options_.step : 1.0) * n;
+  Matrix3Xd g(3, n); // Gradient at x.
+  Matrix3Xd p(3, n); // Newton-step.
+  Matrix3Xd r(3, n); // Residual of Newton-equation H p = -g.
+  Matrix3Xd d(3, n); // Direction of conjugate gradient.
+  Matrix3Xd hd(3, n); // Product of Hessian with d.
+  Matrix3Xd trial(3, n); // Trial-position of line-search.
+  net_force_and_pot(x, g.data(), BOTH);
+  double f= potential_;
+  double norm= g.norm();
+  int status= GSL_CONTINUE;
+  int iter= 0;
+  while(iter < MAX_ITER) {
+    snapshot(x, iter, false);
+    if(norm < tol) {
+      status= GSL_SUCCESS;
+      break;
+    }
+    if(out_of_budget()) {
+      spent_= true; // Current iterate is best so far.
+      save_checkpoint(x, iter, false);
+      break;
+    }
+    if(checkpoint_ && !checkpoint_(done_ + iter, f)) {
+      cancelled_= true; // Start trails best start.
+      break;
+    }
+    ++iter;
+    // Solve H p = -g only as far as forcing term requires, so that steps
+    // far from minimum are cheap and steps near it are nearly exact.
+    // Hessian is indefinite away from minimum; on first direction of
+    // negative curvature, the step so far (or steepest descent) is taken.
+    double const eta= std::min(0.5, std::sqrt(norm));
+    p.setZero();
+    r= g;
+    d= -g;
+    double rr= norm * norm;
+    for(int j= 0; j < MAX_CG; ++j) {
+      // Step so far is taken when time run out.
+      if(j > 0 && out_of_budget()) break;
+      hessian_times(x, d, hd.data());
+      double const dhd= dot(d, hd);
+      if(dhd <= 0.0) {
+        if(j == 0) p= -g;
+        break;
+      }
+      double const alpha= rr / dhd;
+      p+= alpha * d;
+      r+= alpha * hd;
+      double const rr1= r.squaredNorm();
+      if(std::sqrt(rr1) < eta * norm) break;
+      d= (rr1 / rr) * d - r;
+      rr= rr1;
+    }
+    // Long step in nearly flat direction is cut to same scale as layout.
+    double const length= p.norm();
+    if(length > step) p*= step / length;
+    // Backtrack from full step until potential decrease sufficiently.
+    double const slope= dot(g, p);
+    double a= 1.0;
+    bool decreased= false;
+    for(int k= 0; k < MAX_HALVINGS && !decreased; ++k, a*= 0.5) {
+      trial= x + a * p;
+      net_force_and_pot(trial, nullptr, POTENTIAL);
+      decreased= (potential_ <= f + ARMIJO * a * slope);
+    }
+    if(!decreased) {
+      status= GSL_ENOPROG;
+      cerr << "newton_cg: line-search made no progress" << endl;
+      break;
+    }
+    x= trial;
+    f= potential_;
+    net_force_and_pot(x, g.data(), FORCES);
+    norm= g.norm();
+    if(telemetry_.due(iter)) telemetry_.report(iter, f, norm, false, false);
+  }
+  potential_= f;
+  iterations_= iter;
+  converged_= (status == GSL_SUCCESS && !cancelled_);
+  // Local stage of incremental layout is followed by main stage.
+  bool const last= held_.empty() || spent_;
+  telemetry_.report(iter, f, norm, last, converged_ && held_.empty());
+}
+
+
+} // namespace modgraph
+
+// EOF
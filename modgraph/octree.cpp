@@ -0,0 +1,139 @@
+/// @file       octree.cpp
+/// @brief      Definition of modgraph::octree.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "octree.hpp"
+
+using Eigen::Matrix3Xd;
+using Eigen::Vector3d;
+
+
+namespace modgraph {
+
+
+int octree::add_cell(Vector3d const &center, double half, int parent) {
+  cell k;
+  k.center= center;
+  k.half= half;
+  k.sum= Vector3d::Zero();
+  k.count= 0;
+  k.parent= parent;
+  k.first= -1;
+  k.leaf= true;
+  for(int &c: k.child) c= -1;
+  cells_.push_back(k);
+  return int(cells_.size()) - 1;
+}
+
+
+int octree::child(int c, Vector3d const &p) {
+  Vector3d const &ctr= cells_[c].center;
+  int const o= (p[0] >= ctr[0]) | (p[1] >= ctr[1]) << 1 | (p[2] >= ctr[2]) << 2;
+  if(cells_[c].child[o] < 0) {
+    double const h= 0.5 * cells_[c].half;
+    Vector3d const d(o & 1 ? h : -h, o & 2 ? h : -h, o & 4 ? h : -h);
+    int const k= add_cell(ctr + d, h, c); // Invalidates references to cells_.
+    cells_[c].child[o]= k;
+  }
+  return cells_[c].child[o];
+}
+
+
+void octree::insert(int n) {
+  Vector3d const p= pos_.col(n);
+  int c= 0;
+  for(int depth= 0;; ++depth) {
+    if(!cells_[c].leaf) {
+      c= child(c, p);
+      continue;
+    }
+    if(cells_[c].first < 0 || depth == MAX_DEPTH) {
+      next_[n]= cells_[c].first;
+      cells_[c].first= n;
+      return;
+    }
+    // Leaf above MAX_DEPTH holds only one node; push it down one level.
+    int const o= cells_[c].first;
+    cells_[c].first= -1;
+    cells_[c].leaf= false;
+    int const k= child(c, pos_.col(o));
+    next_[o]= -1;
+    cells_[k].first= o;
+    c= child(c, p);
+  }
+}
+
+
+void octree::build(Eigen::Ref<Matrix3Xd const> const &pos) {
+  // Rebind map to caller's data, as Eigen requires, via placement-new.
+  new(&pos_) Eigen::Map<Matrix3Xd const>(pos.data(), 3, pos.cols());
+  int const n= pos.cols();
+  cells_.clear();
+  next_.assign(n, -1);
+  if(n == 0) return;
+  Vector3d const lo= pos.rowwise().minCoeff();
+  Vector3d const hi= pos.rowwise().maxCoeff();
+  // Pad root slightly so that every node lies strictly inside it.
+  double const half= 0.5 * (hi - lo).maxCoeff() * (1.0 + 1.0E-09) + 1.0E-12;
+  add_cell(0.5 * (lo + hi), half, -1);
+  for(int i= 0; i < n; ++i) insert(i);
+  // Fill in each leaf's count and sum, and then, because every child follows
+  // its parent, propagate them toward root in reverse order.
+  for(auto &k: cells_) {
+    for(int b= k.first; b >= 0; b= next_[b]) {
+      k.sum+= pos.col(b);
+      ++k.count;
+    }
+  }
+  for(int c= int(cells_.size()) - 1; c > 0; --c) {
+    cell &p= cells_[cells_[c].parent];
+    p.sum+= cells_[c].sum;
+    p.count+= cells_[c].count;
+  }
+}
+
+
+double octree::repel(
+    int i, double theta, Vector3d &f, quantities q) const {
+  double u= 0.0; // Return-value.
+  if(cells_.empty()) return u;
+  Vector3d const p= pos_.col(i);
+  double const theta2= theta * theta;
+  int stack[7 * MAX_DEPTH + 8]; // Room for every sibling on the way down.
+  int top= 0;
+  stack[top++]= 0;
+  while(top > 0) {
+    cell const &k= cells_[stack[--top]];
+    if(k.count == 0) continue;
+    if(k.leaf) {
+      for(int b= k.first; b >= 0; b= next_[b]) {
+        if(b == i) continue;
+        Vector3d const d= pos_.col(b) - p;
+        double const r= d.norm();
+        if(q & FORCES) f-= d / (r * r * r);
+        if(q & POTENTIAL) u+= 1.0 / r;
+      }
+      continue;
+    }
+    bool const inside= ((p - k.center).cwiseAbs().array() <= k.half).all();
+    Vector3d const d= k.sum / k.count - p;
+    double const r2= d.squaredNorm();
+    double const w= 2.0 * k.half;
+    if(!inside && w * w < theta2 * r2) {
+      // Far enough away to treat cell as single charge at its centroid.
+      double const r= std::sqrt(r2);
+      if(q & FORCES) f-= k.count * d / (r2 * r);
+      if(q & POTENTIAL) u+= k.count / r;
+      continue;
+    }
+    for(int c: k.child) {
+      if(c >= 0) stack[top++]= c;
+    }
+  }
+  return u;
+}
+
+
+} // namespace modgraph
+
+// EOF
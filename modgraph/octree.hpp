@@ -0,0 +1,87 @@
+/// @file       octree.hpp
+/// @brief      Declaration of modgraph::octree.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include "repulsion.hpp" // quantities
+#include <eigen3/Eigen/Dense> // Matrix3Xd, Vector3d
+#include <vector> // vector
+
+namespace modgraph {
+
+
+/// Barnes-Hut octree for approximating universal inverse-square repulsion.
+/// - Every node carries unit charge, so that potential between two nodes
+///   separated by distance r is 1/r.
+/// - Cell far enough from a node is treated as single charge, equal to number
+///   of nodes in cell and located at their centroid.
+/// - Tree is rebuilt from scratch on each evaluation, but storage for cells is
+///   reused across evaluations.
+class octree {
+  /// Deepest level of subdivision; nodes that still share leaf at this depth
+  /// (for example, coincident nodes) are kept together in leaf's bucket.
+  static constexpr int MAX_DEPTH= 32;
+
+  /// Cubical cell of octree.
+  struct cell {
+    Eigen::Vector3d center; ///< Geometric center of cell.
+    double half; ///< Half of width of cell.
+    Eigen::Vector3d sum; ///< Sum of positions of nodes in cell.
+    int count; ///< Number of nodes in cell.
+    int parent; ///< Offset of parent-cell, or -1 for root.
+    int first; ///< First node in leaf's bucket, or -1 if none.
+    bool leaf; ///< True if cell have no children.
+    int child[8]; ///< Offset of each child-cell, or -1 if none.
+  };
+
+  std::vector<cell> cells_; ///< Cells; every child follows its parent.
+  std::vector<int> next_; ///< Next node in same bucket, or -1 if none.
+
+  /// Positions used by build().
+  Eigen::Map<Eigen::Matrix3Xd const> pos_{nullptr, 3, 0};
+
+  /// Append new, empty leaf to cells_.
+  /// @param center  Geometric center of cell.
+  /// @param half  Half of width of cell.
+  /// @param parent  Offset of parent-cell, or -1 for root.
+  /// @return  Offset of new cell.
+  int add_cell(Eigen::Vector3d const &center, double half, int parent);
+
+  /// Offset of child of Cell `c` whose octant contains position `p`, creating
+  /// child if necessary.
+  /// @param c  Offset of parent-cell.
+  /// @param p  Position.
+  /// @return  Offset of child-cell.
+  int child(int c, Eigen::Vector3d const &p);
+
+  /// Insert Node `n` into tree.
+  /// @param n  Offset of node.
+  void insert(int n);
+
+public:
+  /// Build tree for current positions of nodes.
+  /// - Reference to data of `pos` is retained and used by repel(); so data
+  ///   must outlive every subsequent call to repel().
+  /// @param pos  3xN matrix for position of each of N nodes.
+  void build(Eigen::Ref<Eigen::Matrix3Xd const> const &pos);
+
+  /// Approximate inverse-square repulsion felt by Node `i` from every other
+  /// node.
+  /// - repel() does not modify tree and may be called concurrently.
+  /// @param i  Offset of node.
+  /// @param theta  Opening angle: cell of width w at distance d from Node `i`
+  ///               is treated as single charge whenever w / d < theta.
+  /// @param f  On return, incremented by force felt by Node `i`, unless `q`
+  ///           be POTENTIAL.
+  /// @param q  Quantities to compute.
+  /// @return  Sum of 1/r from Node `i` to every other node, or zero if `q` be
+  ///          FORCES.
+  double repel(
+      int i, double theta, Eigen::Vector3d &f, quantities q= BOTH) const;
+};
+
+
+} // namespace modgraph
+
+// EOF
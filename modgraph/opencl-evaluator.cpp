@@ -0,0 +1,365 @@
+/// @file       opencl-evaluator.cpp
+/// @brief      Definition of modgraph::opencl_evaluator.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "opencl-evaluator.hpp"
+
+#ifdef MODGRAPH_OPENCL
+
+#define CL_TARGET_OPENCL_VERSION 120
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+#include <iostream> // cerr, endl
+#include <string> // string
+#include <vector> // vector
+
+using std::vector;
+
+
+namespace modgraph {
+
+
+/// Number of work-items per work-group, and number of nodes per tile of
+/// repulsion; must be power of two.
+constexpr int TILE= 64;
+
+
+/// Source of kernel.
+/// - Gradient is *negative* of net force: Node i feels -d/r^3 from each
+///   other Node j, where d is displacement from i to j, and k d from spring
+///   of constant k.
+/// - Each pair is visited from both ends; so each end takes half of pair's
+///   potential.
+static char const source[]= R"CLC(
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#define TILE 64
+
+__kernel void evaluate(int n,
+                       int want,
+                       __global double const *pos,
+                       __global int const *row,
+                       __global int const *col,
+                       __global double const *k,
+                       __global double *grad,
+                       __global double *part,
+                       __local double *tile,
+                       __local double *red) {
+  int const i= get_global_id(0);
+  int const l= get_local_id(0);
+  bool const live= (i < n);
+  double xi= 0.0, yi= 0.0, zi= 0.0;
+  if(live) {
+    xi= pos[3 * i];
+    yi= pos[3 * i + 1];
+    zi= pos[3 * i + 2];
+  }
+  double gx= 0.0, gy= 0.0, gz= 0.0, u= 0.0;
+  for(int b= 0; b < n; b+= TILE) {
+    int const j= b + l;
+    if(j < n) {
+      tile[3 * l]= pos[3 * j];
+      tile[3 * l + 1]= pos[3 * j + 1];
+      tile[3 * l + 2]= pos[3 * j + 2];
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    int const e= min(TILE, n - b);
+    if(live) {
+      for(int t= 0; t < e; ++t) {
+        if(b + t == i) continue;
+        double const dx= tile[3 * t] - xi;
+        double const dy= tile[3 * t + 1] - yi;
+        double const dz= tile[3 * t + 2] - zi;
+        double const ir= rsqrt(dx * dx + dy * dy + dz * dz);
+        if(want & 1) u+= 0.5 * ir;
+        if(want & 2) {
+          double const q= ir * ir * ir;
+          gx+= dx * q;
+          gy+= dy * q;
+          gz+= dz * q;
+        }
+      }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+  if(live) {
+    for(int s= row[i]; s < row[i + 1]; ++s) {
+      int const j= col[s];
+      double const dx= pos[3 * j] - xi;
+      double const dy= pos[3 * j + 1] - yi;
+      double const dz= pos[3 * j + 2] - zi;
+      if(want & 1) u+= 0.25 * k[s] * (dx * dx + dy * dy + dz * dz);
+      if(want & 2) {
+        gx-= k[s] * dx;
+        gy-= k[s] * dy;
+        gz-= k[s] * dz;
+      }
+    }
+    if(want & 2) {
+      grad[3 * i]= gx;
+      grad[3 * i + 1]= gy;
+      grad[3 * i + 2]= gz;
+    }
+  }
+  red[l]= u;
+  barrier(CLK_LOCAL_MEM_FENCE);
+  for(int h= TILE / 2; h > 0; h>>= 1) {
+    if(l < h) red[l]+= red[l + h];
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+  if(l == 0) part[get_group_id(0)]= red[0];
+}
+)CLC";
+
+
+/// Throw if OpenCL-call failed.
+/// @param err  Status returned by OpenCL.
+/// @param what  Description of call.
+static void check(cl_int err, char const *what) {
+  if(err == CL_SUCCESS) return;
+  std::cerr << "opencl: " << what << " failed with status " << err
+            << std::endl;
+  throw "OpenCL-call failed";
+}
+
+
+struct opencl_evaluator::impl {
+  int n; ///< Number of nodes.
+  int groups; ///< Number of work-groups.
+  cl_device_id device= nullptr; ///< Device in use.
+  cl_context context= nullptr; ///< Context.
+  cl_command_queue queue= nullptr; ///< In-order queue.
+  cl_program program= nullptr; ///< Program built from source.
+  cl_kernel kernel= nullptr; ///< Kernel "evaluate".
+  cl_mem pos= nullptr; ///< Positions (3N).
+  cl_mem row= nullptr; ///< Start of each node's springs (N + 1).
+  cl_mem col= nullptr; ///< Other node of each spring.
+  cl_mem k= nullptr; ///< Constant of each spring.
+  cl_mem grad= nullptr; ///< Gradient (3N).
+  cl_mem part= nullptr; ///< Partial potential of each work-group.
+  vector<double> part_host; ///< Host-copy of partial potentials.
+  std::string name; ///< Name of device.
+
+  ~impl() {
+    for(cl_mem m: {pos, row, col, k, grad, part}) {
+      if(m) clReleaseMemObject(m);
+    }
+    if(kernel) clReleaseKernel(kernel);
+    if(program) clReleaseProgram(program);
+    if(queue) clReleaseCommandQueue(queue);
+    if(context) clReleaseContext(context);
+  }
+};
+
+
+/// First device of given type that supports double precision.
+/// @param type  Type of device, like CL_DEVICE_TYPE_GPU.
+/// @return  Device, or null if none be found.
+static cl_device_id find_device(cl_device_type type) {
+  cl_uint np= 0;
+  if(clGetPlatformIDs(0, nullptr, &np) != CL_SUCCESS || np == 0) {
+    return nullptr;
+  }
+  vector<cl_platform_id> platforms(np);
+  clGetPlatformIDs(np, platforms.data(), nullptr);
+  for(cl_platform_id p: platforms) {
+    cl_uint nd= 0;
+    if(clGetDeviceIDs(p, type, 0, nullptr, &nd) != CL_SUCCESS) continue;
+    vector<cl_device_id> devices(nd);
+    clGetDeviceIDs(p, type, nd, devices.data(), nullptr);
+    for(cl_device_id d: devices) {
+      cl_device_fp_config fp= 0;
+      clGetDeviceInfo(
+          d, CL_DEVICE_DOUBLE_FP_CONFIG, sizeof(fp), &fp, nullptr);
+      if(fp) return d;
+    }
+  }
+  return nullptr;
+}
+
+
+/// Create buffer, copying `data` into it if `data` be non-null.
+/// @param c  Context.
+/// @param bytes  Size of buffer.
+/// @param data  Initial data, or null.
+/// @return  Buffer.
+static cl_mem buffer(cl_context c, size_t bytes, void const *data) {
+  cl_int err;
+  cl_mem_flags const flags= (data ? CL_MEM_COPY_HOST_PTR : 0);
+  // At least one byte, because OpenCL forbids empty buffer.
+  cl_mem const m= clCreateBuffer(c,
+      CL_MEM_READ_WRITE | flags,
+      bytes > 0 ? bytes : 1,
+      bytes > 0 ? const_cast<void *>(data) : nullptr,
+      &err);
+  check(err, "clCreateBuffer");
+  return m;
+}
+
+
+opencl_evaluator::opencl_evaluator(int n, springs const &s):
+    impl_(new impl) {
+  impl &p= *impl_;
+  p.n= n;
+  p.groups= (n + TILE - 1) / TILE;
+  p.device= find_device(CL_DEVICE_TYPE_GPU);
+  if(!p.device) p.device= find_device(CL_DEVICE_TYPE_ALL);
+  if(!p.device) throw "no OpenCL-device with double precision";
+  char name[256]= "";
+  clGetDeviceInfo(p.device, CL_DEVICE_NAME, sizeof(name), name, nullptr);
+  p.name= name;
+  cl_int err;
+  p.context= clCreateContext(nullptr, 1, &p.device, nullptr, nullptr, &err);
+  check(err, "clCreateContext");
+  p.queue= clCreateCommandQueue(p.context, p.device, 0, &err);
+  check(err, "clCreateCommandQueue");
+  char const *src= source;
+  p.program= clCreateProgramWithSource(p.context, 1, &src, nullptr, &err);
+  check(err, "clCreateProgramWithSource");
+  err= clBuildProgram(p.program, 1, &p.device, "", nullptr, nullptr);
+  if(err != CL_SUCCESS) {
+    size_t len= 0;
+    clGetProgramBuildInfo(
+        p.program, p.device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &len);
+    std::string log(len, '\0');
+    clGetProgramBuildInfo(
+        p.program, p.device, CL_PROGRAM_BUILD_LOG, len, &log[0], nullptr);
+    std::cerr << "opencl: build-log:\n" << log << std::endl;
+  }
+  check(err, "clBuildProgram");
+  p.kernel= clCreateKernel(p.program, "evaluate", &err);
+  check(err, "clCreateKernel");
+
+  // Each spring is stored once in springs; device visits it from both ends.
+  auto const &k= s.k();
+  vector<int> row(n + 1, 0);
+  for(int i= 0; i < n; ++i) {
+    for(springs::matrix::InnerIterator it(k, i); it; ++it) {
+      ++row[i + 1];
+      ++row[it.col() + 1];
+    }
+  }
+  for(int i= 0; i < n; ++i) row[i + 1]+= row[i];
+  vector<int> col(row[n]);
+  vector<double> val(row[n]);
+  vector<int> fill(row.begin(), row.end() - 1);
+  for(int i= 0; i < n; ++i) {
+    for(springs::matrix::InnerIterator it(k, i); it; ++it) {
+      int const j= it.col();
+      col[fill[i]]= j;
+      val[fill[i]++]= it.value();
+      col[fill[j]]= i;
+      val[fill[j]++]= it.value();
+    }
+  }
+  p.pos= buffer(p.context, 3 * n * sizeof(double), nullptr);
+  p.row= buffer(p.context, row.size() * sizeof(int), row.data());
+  p.col= buffer(p.context, col.size() * sizeof(int), col.data());
+  p.k= buffer(p.context, val.size() * sizeof(double), val.data());
+  p.grad= buffer(p.context, 3 * n * sizeof(double), nullptr);
+  p.part= buffer(p.context, p.groups * sizeof(double), nullptr);
+  p.part_host.resize(p.groups);
+  cl_int const cn= n;
+  check(clSetKernelArg(p.kernel, 0, sizeof(cl_int), &cn), "clSetKernelArg");
+  cl_mem const mems[]= {p.pos, p.row, p.col, p.k, p.grad, p.part};
+  for(int a= 0; a < 6; ++a) {
+    check(clSetKernelArg(p.kernel, a + 2, sizeof(cl_mem), &mems[a]),
+        "clSetKernelArg");
+  }
+  check(clSetKernelArg(p.kernel, 8, 3 * TILE * sizeof(double), nullptr),
+      "clSetKernelArg");
+  check(clSetKernelArg(p.kernel, 9, TILE * sizeof(double), nullptr),
+      "clSetKernelArg");
+}
+
+
+opencl_evaluator::~opencl_evaluator() {}
+
+
+double opencl_evaluator::evaluate(
+    double const *pos, double *grad, quantities q) {
+  impl &p= *impl_;
+  if(p.n == 0) return 0.0;
+  size_t const bytes= 3 * p.n * sizeof(double);
+  check(clEnqueueWriteBuffer(
+            p.queue, p.pos, CL_FALSE, 0, bytes, pos, 0, nullptr, nullptr),
+      "clEnqueueWriteBuffer");
+  cl_int const want= q;
+  check(clSetKernelArg(p.kernel, 1, sizeof(cl_int), &want), "clSetKernelArg");
+  size_t const global= size_t(p.groups) * TILE;
+  size_t const local= TILE;
+  check(clEnqueueNDRangeKernel(p.queue,
+            p.kernel,
+            1,
+            nullptr,
+            &global,
+            &local,
+            0,
+            nullptr,
+            nullptr),
+      "clEnqueueNDRangeKernel");
+  if(q & FORCES) {
+    check(clEnqueueReadBuffer(
+              p.queue, p.grad, CL_FALSE, 0, bytes, grad, 0, nullptr, nullptr),
+        "clEnqueueReadBuffer");
+  }
+  double u= 0.0;
+  if(q & POTENTIAL) {
+    check(clEnqueueReadBuffer(p.queue,
+              p.part,
+              CL_FALSE,
+              0,
+              p.groups * sizeof(double),
+              p.part_host.data(),
+              0,
+              nullptr,
+              nullptr),
+        "clEnqueueReadBuffer");
+  }
+  check(clFinish(p.queue), "clFinish");
+  if(q & POTENTIAL) {
+    for(double v: p.part_host) u+= v;
+  }
+  return u;
+}
+
+
+char const *opencl_evaluator::device_name() const {
+  return impl_->name.c_str();
+}
+
+
+} // namespace modgraph
+
+#else // MODGRAPH_OPENCL
+
+namespace modgraph {
+
+
+struct opencl_evaluator::impl {};
+
+
+opencl_evaluator::opencl_evaluator(int, springs const &) {
+  throw "modgraph was built without OpenCL (make OPENCL=1)";
+}
+
+
+opencl_evaluator::~opencl_evaluator() {}
+
+
+double opencl_evaluator::evaluate(double const *, double *, quantities) {
+  return 0.0;
+}
+
+
+char const *opencl_evaluator::device_name() const { return "none"; }
+
+
+} // namespace modgraph
+
+#endif // MODGRAPH_OPENCL
+
+// EOF
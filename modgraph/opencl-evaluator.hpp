@@ -0,0 +1,57 @@
+/// @file       opencl-evaluator.hpp
+/// @brief      Declaration of modgraph::opencl_evaluator.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+///
+/// Backend is compiled only when MODGRAPH_OPENCL be defined ('make
+/// OPENCL=1'); otherwise, constructor of opencl_evaluator throws.
+
+#pragma once
+
+#include "repulsion.hpp" // quantities
+#include "springs.hpp" // springs
+#include <memory> // unique_ptr
+
+namespace modgraph {
+
+
+/// Exact evaluation of forces and potential on OpenCL-device (typically
+/// GPU).
+/// - Springs are uploaded once, when evaluator is constructed.
+/// - On each evaluation, only positions are uploaded, and only gradient (if
+///   wanted) and one partial potential per work-group are downloaded.
+/// - Each work-item handles one node, summing repulsion over every other node
+///   in tiles staged through local memory, and then applying node's springs;
+///   so no atomic operation is needed, and result is reproducible on given
+///   device.
+/// - Device must support double precision (cl_khr_fp64).
+class opencl_evaluator {
+  struct impl; ///< Handles of OpenCL-objects.
+  std::unique_ptr<impl> impl_; ///< Handles of OpenCL-objects.
+
+public:
+  /// Choose device, build kernel, and upload springs.
+  /// - Exception is thrown if no suitable device be found.
+  /// @param n  Number of nodes.
+  /// @param s  Springs, stored once per pair.
+  opencl_evaluator(int n, springs const &s);
+
+  /// Release OpenCL-objects.
+  ~opencl_evaluator();
+
+  /// Evaluate potential, gradient, or both.
+  /// @param pos  3N components of positions, as in 3xN column-major matrix.
+  /// @param grad  Storage for 3N components of gradient (negative of net
+  ///              force), or null if `q` be POTENTIAL.
+  /// @param q  Quantities to compute.
+  /// @return  Potential, or zero if `q` be FORCES.
+  double evaluate(double const *pos, double *grad, quantities q);
+
+  /// Name of device in use.
+  /// @return  Name reported by OpenCL.
+  char const *device_name() const;
+};
+
+
+} // namespace modgraph
+
+// EOF
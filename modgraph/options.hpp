@@ -0,0 +1,205 @@
+/// @file       options.hpp
+/// @brief      Definition of modgraph::options.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include "telemetry.hpp" // progress_callback
+#include <string> // string
+
+namespace modgraph {
+
+
+/// Run-time options governing layout of graph.
+struct options {
+  /// Opening angle for Barnes-Hut approximation of universal repulsion.
+  /// - Zero (default) means that repulsion be calculated exactly for every
+  ///   pair of nodes.
+  /// - Otherwise, cell of width w at distance d from node is treated as single
+  ///   charge whenever w / d < theta; 0.5 is typical.
+  /// - Attractions are always calculated exactly.
+  double theta= 0.0;
+
+  /// Scale of attraction along each directed edge; spring-constant is its
+  /// reciprocal.
+  /// - Zero disables attraction along edges.
+  double edge_attract= 1.5;
+
+  /// Relative scale of attraction of Node i to Node j whenever (i + j) % m be
+  /// factor of modulus m or m minus such factor.
+  /// - Zero disables attraction by sum.
+  double sum_attract= 15.0;
+
+  /// Relative scale of attraction of Node i to Node j whenever j be factor f
+  /// of modulus m or m - f.
+  /// - Zero disables attraction by factor.
+  double factor_attract= 150.0;
+
+  /// True if exact evaluation should be offloaded to OpenCL-device (GPU).
+  /// - Available only if modgraph were built with 'make OPENCL=1'.
+  /// - Requires exact repulsion (theta of zero); threads is then ignored.
+  bool gpu= false;
+
+  /// Precision of exact repulsion on CPU.
+  /// - "double" (default) computes every pair in double precision.
+  /// - "float" computes every pair in single precision, at twice SIMD-width,
+  ///   but sums potential and forces in double precision; convergence is
+  ///   declared when norm of gradient fall below 1000 times tolerance.
+  /// - "mixed" uses single precision until norm of gradient fall below 1000
+  ///   times tolerance (or until single precision stop making progress), and
+  ///   then continues in double precision to convergence; so final layout
+  ///   is as precise as for "double".
+  /// - Ignored when theta be nonzero, when gpu be true, or by newton_cg.
+  std::string precision= "double";
+
+  /// Number of threads that share each evaluation of forces and potential.
+  /// - Result is bit-for-bit reproducible for given number of threads.
+  int threads= 1;
+
+  /// Directory of cached layouts, or empty if no cache be used.
+  /// - If layout for identical modulus and parameters be cached, then
+  ///   minimization is skipped.
+  /// - Otherwise, layout cached for same modulus and nearest parameters, if
+  ///   any, is starting point for minimization.
+  /// - Only converged layout of full precision is stored; so layout of
+  ///   precision "float", or stopped by deadline, budget, or failure of
+  ///   GSL, never becomes exact hit.
+  std::string cache_dir;
+
+  /// Directory of checkpoints, or empty (default) if no checkpoint be
+  /// written.
+  /// - Positions, stage, and number of iterations are written to
+  ///   N-hash.ckpt (hash of parameters, as for cache) every
+  ///   checkpoint_every iterations, and when deadline or budget run out;
+  ///   layout of modulus N with same parameters resumes from its
+  ///   checkpoint, and checkpoint is removed once layout be complete.
+  /// - Ignored by layout of subset and when starts exceed 1.
+  std::string checkpoint_dir;
+
+  /// Number of iterations between checkpoints.
+  int checkpoint_every= 1000;
+
+  /// Number of iterations between frames, or zero (default) for none.
+  /// - Scene of every k-th iterate (counted over every stage, from 0) is
+  ///   written in chosen format, as N-hash-frame-0000000.asy and so on, for
+  ///   animation of convergence.
+  /// - Ignored as checkpoint_dir is.
+  int frame_every= 0;
+
+  /// Name of GSL's minimization-algorithm.
+  /// - "vector_bfgs2" (default), "vector_bfgs", "conjugate_pr",
+  ///   "conjugate_fr", and "steepest_descent" use forces.
+  /// - "nmsimplex2" uses only potential.
+  /// - "newton_cg" is truncated-Newton method, not GSL's, whose each step is
+  ///   found by conjugate gradients with analytic products of Hessian; it
+  ///   requires exact repulsion and always computes in double precision.
+  std::string algorithm= "vector_bfgs2";
+
+  /// Size of first trial-step (gradient-methods) or initial size of simplex
+  /// in every coordinate (nmsimplex2); for newton_cg, N times step bounds
+  /// length of each step.
+  /// - Zero means default: 1 for gradient-methods, 10 for nmsimplex2.
+  double step= 0.0;
+
+  /// Tolerance of each line-search in gradient-methods.
+  double line_tol= 0.1;
+
+  /// Convergence-tolerance: largest norm of gradient (gradient-methods) or
+  /// largest size of simplex (nmsimplex2) at minimum.
+  /// - Zero means default: 1.0E-05 for gradient-methods, 0.1 for nmsimplex2.
+  double tol= 0.0;
+
+  /// Largest wall-clock time, in seconds, of layout, or zero (default) for
+  /// no limit.
+  /// - When time run out, minimization stops with best layout found so
+  ///   far, which is reported as not converged and is not cached.
+  /// - Time is checked once per iteration, and is shared by every stage of
+  ///   layout (multilevel, mirror-constrained, and main).
+  double deadline= 0.0;
+
+  /// Largest number of evaluations of potential, forces, or both, or zero
+  /// (default) for no limit.
+  /// - When budget be spent, minimization stops as when deadline pass.
+  /// - Budget is shared by every stage of layout, but each of several
+  ///   starts has its own; each product with Hessian (newton_cg) counts as
+  ///   one evaluation.
+  int budget= 0;
+
+  /// True if full layout should start from multilevel layout rather than
+  /// from random positions.
+  /// - Leaves of every tree hanging off cycle of squaring map are peeled,
+  ///   level by level, down to cycles; coarsest level is minimized from
+  ///   random positions, and each finer level starts with every new node
+  ///   placed near its successor.
+  /// - Ignored when layout start from cached layout.
+  bool multilevel= false;
+
+  /// True if minimization should begin with every pair of mirror-nodes i and
+  /// m - i constrained to positions reflected through plane x = 0.
+  /// - Node equal to its own mirror (0, and m/2 if m be even) is confined to
+  ///   that plane.
+  /// - Constrained stage minimizes over about half of coordinates, and its
+  ///   exact repulsion (on CPU) computes one pair of each orbit under
+  ///   mirror-map, about N^2/4 pairs instead of N^2/2; then
+  ///   constraint is released, and every node is refined, because squaring
+  ///   map sends i and m - i to same node, so that potential is not exactly
+  ///   symmetric.
+  /// - Ignored by nmsimplex2, by newton_cg, and by layout of subset.
+  bool mirror= false;
+
+  /// Number of independent starts, each from its own random positions, whose
+  /// lowest final potential is kept.
+  /// - Every start runs concurrently on its own thread (each evaluation of
+  ///   which still uses `threads` threads).
+  /// - Start k draws initial positions from generator seeded by seed + k;
+  ///   so start 0 is as for single start.
+  int starts= 1;
+
+  /// Relative margin by which start's potential may trail best of every
+  /// start before start be cancelled, or zero (default) for no
+  /// cancellation.
+  /// - Starts are compared every 100 iterations, at common iteration, so
+  ///   that result is reproducible.
+  double start_margin= 0.0;
+
+  /// Seed of random initial positions (and of placement by multilevel).
+  /// - Zero (default) gives same positions as ever for each modulus.
+  unsigned seed= 0;
+
+  /// Format of scene written for each modulus N.
+  /// - "asy" (default) writes N.asy for asymptote.
+  /// - "ply" writes N.ply, binary PLY of vertices and edges, which modern
+  ///   viewer loads quickly even for many thousands of nodes.
+  std::string format= "asy";
+
+  /// True if service lay out new modulus incrementally (see
+  /// incremental.hpp) from cached layout of nearest modulus with same seed,
+  /// rather than from random positions.
+  bool incremental= false;
+
+  /// Archive of layouts (see archive.hpp), or empty (default) for none.
+  /// - Batch of moduli appends each layout to archive instead of writing
+  ///   scene.
+  /// - Service answers request for archived modulus from archive, unless
+  ///   request give seed other than default.
+  std::string archive;
+
+  /// Format of progress of minimization: "text" (default), "csv", "json"
+  /// (one object per line), or "none".
+  std::string progress_format= "text";
+
+  /// File to which progress is appended, or empty (default) for stdout.
+  std::string progress_path;
+
+  /// Number of iterations between reports of progress; final state is
+  /// always reported.
+  int progress_every= 100;
+
+  /// Function called with each report of progress, or empty (default).
+  progress_callback on_progress;
+};
+
+
+} // namespace modgraph
+
+// EOF
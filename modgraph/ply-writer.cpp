@@ -0,0 +1,70 @@
+/// @file       ply-writer.cpp
+/// @brief      Definition of modgraph::write_ply().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "ply-writer.hpp"
+#include <cstdint> // int32_t, uint16_t
+#include <cstring> // memcpy
+#include <fstream> // ofstream
+#include <sstream> // ostringstream
+
+using std::string;
+using std::vector;
+
+
+namespace modgraph {
+
+
+/// Append bytes of value to buffer.
+/// @param buf  Buffer.
+/// @param v  Value.
+template<typename T> void append(vector<char> &buf, T v) {
+  char b[sizeof(T)];
+  std::memcpy(b, &v, sizeof(T));
+  buf.insert(buf.end(), b, b + sizeof(T));
+}
+
+
+/// Name of PLY's format for byte-order of host.
+/// @return  "binary_little_endian" or "binary_big_endian".
+char const *host_format() {
+  std::uint16_t const one= 1;
+  char low;
+  std::memcpy(&low, &one, 1);
+  return low ? "binary_little_endian" : "binary_big_endian";
+}
+
+
+void write_ply(string const &path,
+    Eigen::Matrix3Xd const &pos,
+    vector<edge> const &edges) {
+  std::ostringstream oss;
+  oss << "ply\n"
+      << "format " << host_format() << " 1.0\n"
+      << "comment modgraph: squaring map, one vertex per node\n"
+      << "element vertex " << pos.cols() << "\n"
+      << "property float x\n"
+      << "property float y\n"
+      << "property float z\n"
+      << "element edge " << edges.size() << "\n"
+      << "property int vertex1\n"
+      << "property int vertex2\n"
+      << "end_header\n";
+  string const head= oss.str();
+  vector<char> buf(head.begin(), head.end());
+  buf.reserve(head.size() + 12 * pos.cols() + 8 * edges.size());
+  for(int i= 0; i < pos.cols(); ++i) {
+    for(int k= 0; k < 3; ++k) append(buf, float(pos(k, i)));
+  }
+  for(auto const &e: edges) {
+    append(buf, std::int32_t(e[0]));
+    append(buf, std::int32_t(e[1]));
+  }
+  std::ofstream ofs(path, std::ios::binary);
+  if(!ofs.write(buf.data(), buf.size())) throw "cannot write ply-file";
+}
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,38 @@
+/// @file       ply-writer.hpp
+/// @brief      Declaration of modgraph::write_ply().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include <array> // array
+#include <eigen3/Eigen/Core> // Matrix3Xd
+#include <string> // string
+#include <vector> // vector
+
+namespace modgraph {
+
+
+/// Directed edge from first node to second node.
+using edge= std::array<int, 2>;
+
+
+/// Write scene in binary PLY-format.
+/// - Every node is a vertex with single-precision coordinates x, y, and z.
+/// - Every directed edge is an element "edge" with properties "vertex1"
+///   (tail) and "vertex2" (head), as understood by common viewers (for
+///   example, MeshLab and Blender), which draw each edge as line and may
+///   instance one sphere per vertex.
+/// - Numbers are stored in byte-order of host, which header declares.
+/// - File is built in memory and written by single call, so that even
+///   scene of very many nodes is written in a fraction of a second.
+/// @param path  Path of file.
+/// @param pos  3xN matrix for position of each of N nodes.
+/// @param edges  Directed edges.
+void write_ply(std::string const &path,
+    Eigen::Matrix3Xd const &pos,
+    std::vector<edge> const &edges);
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,61 @@
+/// @file       position-file.cpp
+/// @brief      Definition of modgraph::write_positions() and
+///             modgraph::read_positions().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "position-file.hpp"
+#include <filesystem> // create_directories, rename, remove
+#include <iostream> // cerr, endl
+#include <sstream> // ostringstream
+#include <thread> // this_thread
+#include <unistd.h> // getpid()
+
+namespace fs= std::filesystem;
+using std::string;
+
+
+namespace modgraph {
+
+
+void write_positions(string const &path,
+    void const *header,
+    std::size_t size,
+    Eigen::Matrix3Xd const &pos,
+    char const *who) {
+  std::error_code ec;
+  fs::path const parent= fs::path(path).parent_path();
+  if(!parent.empty()) fs::create_directories(parent, ec);
+  std::ostringstream oss;
+  oss << path << ".tmp." << getpid() << "." << std::this_thread::get_id();
+  string const tmp= oss.str();
+  {
+    std::ofstream ofs(tmp, std::ios::binary);
+    ofs.write(static_cast<char const *>(header), std::streamsize(size));
+    ofs.write(reinterpret_cast<char const *>(pos.data()),
+        std::streamsize(sizeof(double) * pos.size()));
+    if(!ofs) {
+      std::cerr << who << ": cannot write " << tmp << std::endl;
+      fs::remove(tmp, ec);
+      return;
+    }
+  }
+  fs::rename(tmp, path, ec);
+  if(ec) {
+    std::cerr << who << ": cannot rename to " << path << std::endl;
+    fs::remove(tmp, ec);
+  }
+}
+
+
+bool read_positions(std::istream &is, int nodes, Eigen::Matrix3Xd &pos) {
+  Eigen::Matrix3Xd p(3, nodes);
+  auto const bytes= std::streamsize(sizeof(double) * p.size());
+  if(!is.read(reinterpret_cast<char *>(p.data()), bytes)) return false;
+  pos= std::move(p);
+  return true;
+}
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,88 @@
+/// @file       position-file.hpp
+/// @brief      Declaration of modgraph::write_positions() and
+///             modgraph::read_positions().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+///
+/// Compact binary file of fixed header followed by 3xN doubles, shared by
+/// layout_cache and checkpoint_dir.
+/// - Header is struct whose first member is `char magic[8]` and which has
+///   members `layout_key key` and `int32_t nodes`.
+
+#pragma once
+
+#include "layout-cache.hpp" // layout_key
+#include <cstdint> // int32_t
+#include <cstring> // memcpy, memcmp
+#include <cstddef> // size_t
+#include <eigen3/Eigen/Core> // Matrix3Xd
+#include <fstream> // ifstream
+#include <istream> // istream
+#include <string> // string
+
+namespace modgraph {
+
+
+/// New header of file of positions.
+/// @tparam H  Type of header.
+/// @param magic  First bytes of file.
+/// @param k  Key for layout.
+/// @param nodes  Number N of nodes.
+/// @return  Header whose other members (and padding) are zero.
+template<typename H>
+H new_header(char const (&magic)[8], layout_key const &k, int nodes) {
+  H h{}; // Zero padding too, so that file be reproducible.
+  std::memcpy(h.magic, magic, sizeof(h.magic));
+  h.key= k;
+  h.nodes= int32_t(nodes);
+  return h;
+}
+
+
+/// Write header and positions atomically: to temporary file named by
+/// process and thread, so that concurrent writers never share it, and then
+/// by rename to `path`.
+/// - Failure is reported to std::cerr but is never fatal.
+/// @param path  Path of file.
+/// @param header  Header.
+/// @param size  Size of header in bytes.
+/// @param pos  3xN matrix of positions.
+/// @param who  Prefix of message on failure, like "layout_cache".
+void write_positions(std::string const &path,
+    void const *header,
+    std::size_t size,
+    Eigen::Matrix3Xd const &pos,
+    char const *who);
+
+
+/// Read 3xN matrix of positions.
+/// @param is  Stream positioned after header.
+/// @param nodes  Number N of nodes.
+/// @param pos  On successful return, positions.
+/// @return  True on success.
+bool read_positions(std::istream &is, int nodes, Eigen::Matrix3Xd &pos);
+
+
+/// Read header and (optionally) positions.
+/// @tparam H  Type of header.
+/// @param path  Path of file.
+/// @param magic  Expected first bytes of file.
+/// @param h  On successful return, header of file.
+/// @param pos  If nonnull, on successful return, positions.
+/// @return  True if file hold header with `magic` and with number of nodes
+///          equal to modulus, and (if `pos` be nonnull) every position.
+template<typename H>
+bool read_positions(std::string const &path,
+    char const (&magic)[8],
+    H &h,
+    Eigen::Matrix3Xd *pos) {
+  std::ifstream ifs(path, std::ios::binary);
+  if(!ifs.read(reinterpret_cast<char *>(&h), sizeof(h))) return false;
+  if(std::memcmp(h.magic, magic, sizeof(h.magic)) != 0) return false;
+  if(h.nodes != h.key.modulus) return false;
+  return !pos || read_positions(ifs, h.nodes, *pos);
+}
+
+
+} // namespace modgraph
+
+// EOF
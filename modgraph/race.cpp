@@ -0,0 +1,45 @@
+/// @file       race.cpp
+/// @brief      Definition of modgraph::race.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "race.hpp"
+#include <algorithm> // min
+#include <cmath> // abs
+
+
+namespace modgraph {
+
+
+bool race::check(int iter, double f) {
+  // Random initial potentials say little; so first checkpoint is at `every`.
+  if(margin_ <= 0.0 || iter == 0 || iter % every_) return true;
+  std::unique_lock<std::mutex> lock(mutex_);
+  checkpoint &c= points_[iter];
+  c.best= (c.arrived == 0 ? f : std::min(c.best, f));
+  ++c.arrived;
+  arrival_.notify_all();
+  // Every start still running either reaches this checkpoint or finishes
+  // before it.
+  arrival_.wait(lock, [&] { return c.arrived >= alive_; });
+  // Losing start is cancelled here, at check, and never adds final
+  // potential.  Start that completed at this iteration stopped before its
+  // check; so it did not arrive, and its final potential counts.
+  double best= c.best;
+  for(auto const &e: finals_) {
+    if(e.first <= iter) best= std::min(best, e.second);
+  }
+  return f <= best + margin_ * std::abs(best);
+}
+
+
+void race::finish(int iter, double f, bool completed) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(completed) finals_.push_back({iter, f});
+  --alive_;
+  arrival_.notify_all();
+}
+
+
+} // namespace modgraph
+
+// EOF
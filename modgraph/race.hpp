@@ -0,0 +1,70 @@
+/// @file       race.hpp
+/// @brief      Declaration of modgraph::race.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include <condition_variable> // condition_variable
+#include <map> // map
+#include <mutex> // mutex
+#include <utility> // pair
+#include <vector> // vector
+
+namespace modgraph {
+
+
+/// Lockstep comparison of concurrent minimizations from different starts, so
+/// that unpromising start can be cancelled early.
+/// - At every checkpoint (every `every` iterations), each start waits until
+///   every other start still running reach same checkpoint; then start whose
+///   potential trail best by more than margin is cancelled.
+/// - Best is lowest potential at checkpoint, or lowest final potential of any
+///   start that completed at or before checkpoint.
+/// - Because starts are compared only at common checkpoints, which start be
+///   cancelled never depends on timing of threads.
+class race {
+  int const every_; ///< Number of iterations between checkpoints.
+  double const margin_; ///< Relative margin, or zero for no cancellation.
+  std::mutex mutex_; ///< Guard for every member below.
+  std::condition_variable arrival_; ///< Signal of arrival or of finish.
+  int alive_; ///< Number of starts still running.
+
+  /// State of one checkpoint.
+  struct checkpoint {
+    int arrived= 0; ///< Number of starts that reached checkpoint.
+    double best= 0.0; ///< Lowest potential at checkpoint.
+  };
+
+  std::map<int, checkpoint> points_; ///< Every checkpoint reached so far.
+
+  /// Iteration and final potential of each start that finished.
+  std::vector<std::pair<int, double>> finals_;
+
+public:
+  /// Initialize race.
+  /// @param starts  Number of starts.
+  /// @param every  Number of iterations between checkpoints.
+  /// @param margin  Relative margin by which start may trail best before it
+  ///                be cancelled; zero disables cancellation.
+  race(int starts, int every, double margin):
+      every_(every), margin_(margin), alive_(starts) {}
+
+  /// Report potential at iteration, and wait at checkpoint for other starts.
+  /// @param iter  Number of iterations so far.
+  /// @param f  Current potential.
+  /// @return  False if start should be cancelled.
+  bool check(int iter, double f);
+
+  /// Report that start finished or were cancelled.
+  /// - Every start must call finish() exactly once, even on failure, lest
+  ///   other starts wait forever.
+  /// @param iter  Number of iterations performed.
+  /// @param f  Final potential.
+  /// @param completed  False if start were cancelled or failed.
+  void finish(int iter, double f, bool completed);
+};
+
+
+} // namespace modgraph
+
+// EOF
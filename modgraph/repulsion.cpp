@@ -0,0 +1,696 @@
+/// @file       repulsion.cpp
+/// @brief      Definition of modgraph::repel_row(), modgraph::hess_row(),
+///             and their kernels.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "repulsion.hpp"
+#include <cmath> // sqrt
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define MODGRAPH_X86_KERNELS
+#include <immintrin.h> // AVX2 and AVX-512 intrinsics
+#endif
+
+namespace modgraph {
+
+
+/// Signature of kernel that repels Node i from every Node j in (i, n).
+/// - Arguments are coordinates x, y, and z of every node; offset i; number n
+///   of nodes; and components fx, fy, and fz of force on every node.
+/// - Return-value is sum of 1/r over every pair.
+/// @tparam T  Scalar type of coordinates and of forces.
+template<typename T>
+using row_kernel= double (*)(
+    T const *, T const *, T const *, int, int, T *, T *, T *);
+
+
+/// Scalar kernel, used for remainder of row by every kernel.
+/// - Arguments and return-value are described at row_kernel.
+/// - Template-parameters P and F select computation of potential and of
+///   forces, so that work not needed is compiled out; T is scalar type of
+///   arithmetic for each pair, while potential is summed in double.
+/// @param j  First Node j.
+/// @param u  Potential accumulated so far.
+/// @param gx  Reference to x-component of force on Node i so far.
+/// @param gy  Reference to y-component of force on Node i so far.
+/// @param gz  Reference to z-component of force on Node i so far.
+template<typename T, bool P, bool F>
+inline double repel_scalar(T const *x,
+    T const *y,
+    T const *z,
+    int i,
+    int j,
+    int n,
+    T *fx,
+    T *fy,
+    T *fz,
+    double u,
+    T &gx,
+    T &gy,
+    T &gz) {
+  for(; j < n; ++j) {
+    T const dx= x[j] - x[i];
+    T const dy= y[j] - y[i];
+    T const dz= z[j] - z[i];
+    T const r= T(1) / std::sqrt(dx * dx + dy * dy + dz * dz); // 1/r
+    if constexpr(P) u+= r;
+    if constexpr(F) {
+      T const q= r * r * r; // 1/r^3
+      // Node i feels -d/r^3; Node j feels +d/r^3.
+      gx-= dx * q;
+      gy-= dy * q;
+      gz-= dz * q;
+      fx[j]+= dx * q;
+      fy[j]+= dy * q;
+      fz[j]+= dz * q;
+    }
+  }
+  return u;
+}
+
+
+template<typename T, bool P, bool F>
+double repel_row_scalar(T const *x,
+    T const *y,
+    T const *z,
+    int i,
+    int n,
+    T *fx,
+    T *fy,
+    T *fz) {
+  T gx= 0, gy= 0, gz= 0;
+  double const u= repel_scalar<T, P, F>(
+      x, y, z, i, i + 1, n, fx, fy, fz, 0.0, gx, gy, gz);
+  if constexpr(F) {
+    fx[i]+= gx;
+    fy[i]+= gy;
+    fz[i]+= gz;
+  }
+  return u;
+}
+
+
+/// Signature of kernel that adds, for each Node j in (i, n), product of
+/// Hessian of 1/r between Node i and Node j with direction.
+/// - Arguments are coordinates x, y, and z of every node; components vx, vy,
+///   and vz of direction at every node; offset i; number n of nodes; and
+///   components hx, hy, and hz of product at every node.
+using hess_kernel= void (*)(double const *,
+    double const *,
+    double const *,
+    double const *,
+    double const *,
+    double const *,
+    int,
+    int,
+    double *,
+    double *,
+    double *);
+
+
+/// Scalar kernel for product of Hessian with direction, used for remainder
+/// of row by every such kernel.
+/// - Arguments are described at hess_kernel.
+/// - For displacement d from Node i to Node j, and for difference w of
+///   direction between them, Hessian's block contributes
+///   (3 (d.w) d / r^2 - w) / r^3 to Node j and its negative to Node i.
+/// @param j  First Node j.
+/// @param gx  Reference to x-component of product at Node i so far.
+/// @param gy  Reference to y-component of product at Node i so far.
+/// @param gz  Reference to z-component of product at Node i so far.
+inline void hess_scalar(double const *x,
+    double const *y,
+    double const *z,
+    double const *vx,
+    double const *vy,
+    double const *vz,
+    int i,
+    int j,
+    int n,
+    double *hx,
+    double *hy,
+    double *hz,
+    double &gx,
+    double &gy,
+    double &gz) {
+  for(; j < n; ++j) {
+    double const dx= x[j] - x[i];
+    double const dy= y[j] - y[i];
+    double const dz= z[j] - z[i];
+    double const wx= vx[j] - vx[i];
+    double const wy= vy[j] - vy[i];
+    double const wz= vz[j] - vz[i];
+    double const s= 1.0 / (dx * dx + dy * dy + dz * dz); // 1/r^2
+    double const q= s * std::sqrt(s); // 1/r^3
+    double const t= 3.0 * s * (dx * wx + dy * wy + dz * wz);
+    double const ax= q * (t * dx - wx);
+    double const ay= q * (t * dy - wy);
+    double const az= q * (t * dz - wz);
+    gx-= ax;
+    gy-= ay;
+    gz-= az;
+    hx[j]+= ax;
+    hy[j]+= ay;
+    hz[j]+= az;
+  }
+}
+
+
+void hess_row_scalar(double const *x,
+    double const *y,
+    double const *z,
+    double const *vx,
+    double const *vy,
+    double const *vz,
+    int i,
+    int n,
+    double *hx,
+    double *hy,
+    double *hz) {
+  double gx= 0.0, gy= 0.0, gz= 0.0;
+  hess_scalar(x, y, z, vx, vy, vz, i, i + 1, n, hx, hy, hz, gx, gy, gz);
+  hx[i]+= gx;
+  hy[i]+= gy;
+  hz[i]+= gz;
+}
+
+
+#ifdef MODGRAPH_X86_KERNELS
+
+/// Sum of four lanes.
+/// @param v  Vector of four doubles.
+/// @return  Sum of lanes.
+__attribute__((target("avx2,fma"))) inline double hsum(__m256d v) {
+  __m128d const s= _mm_add_pd(_mm256_castpd256_pd128(v),
+      _mm256_extractf128_pd(v, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+
+/// AVX2-kernel, processing four nodes at once.
+/// - Arguments and return-value are described at row_kernel.
+/// - Single-precision estimate of 1/r (12 bits) is refined by three
+///   Newton-Raphson steps to full double precision.
+template<bool P, bool F>
+__attribute__((target("avx2,fma"))) double repel_row_avx2(
+    double const *x,
+    double const *y,
+    double const *z,
+    int i,
+    int n,
+    double *fx,
+    double *fy,
+    double *fz) {
+  __m256d const xi= _mm256_set1_pd(x[i]);
+  __m256d const yi= _mm256_set1_pd(y[i]);
+  __m256d const zi= _mm256_set1_pd(z[i]);
+  __m256d const three_halves= _mm256_set1_pd(1.5);
+  __m256d const half= _mm256_set1_pd(0.5);
+  __m256d gx= _mm256_setzero_pd(), gy= gx, gz= gx, u= gx;
+  int j= i + 1;
+  for(; j + 4 <= n; j+= 4) {
+    __m256d const dx= _mm256_sub_pd(_mm256_loadu_pd(x + j), xi);
+    __m256d const dy= _mm256_sub_pd(_mm256_loadu_pd(y + j), yi);
+    __m256d const dz= _mm256_sub_pd(_mm256_loadu_pd(z + j), zi);
+    __m256d const r2= _mm256_fmadd_pd(
+        dx, dx, _mm256_fmadd_pd(dy, dy, _mm256_mul_pd(dz, dz)));
+    __m256d const h= _mm256_mul_pd(half, r2);
+    __m256d r= _mm256_cvtps_pd(_mm_rsqrt_ps(_mm256_cvtpd_ps(r2)));
+    for(int k= 0; k < 3; ++k) {
+      // r <- r * (3/2 - r2 * r * r / 2)
+      r= _mm256_mul_pd(
+          r, _mm256_fnmadd_pd(h, _mm256_mul_pd(r, r), three_halves));
+    }
+    if constexpr(P) u= _mm256_add_pd(u, r);
+    if constexpr(!F) continue;
+    __m256d const q= _mm256_mul_pd(_mm256_mul_pd(r, r), r); // 1/r^3
+    __m256d const qx= _mm256_mul_pd(dx, q);
+    __m256d const qy= _mm256_mul_pd(dy, q);
+    __m256d const qz= _mm256_mul_pd(dz, q);
+    gx= _mm256_sub_pd(gx, qx);
+    gy= _mm256_sub_pd(gy, qy);
+    gz= _mm256_sub_pd(gz, qz);
+    _mm256_storeu_pd(fx + j, _mm256_add_pd(_mm256_loadu_pd(fx + j), qx));
+    _mm256_storeu_pd(fy + j, _mm256_add_pd(_mm256_loadu_pd(fy + j), qy));
+    _mm256_storeu_pd(fz + j, _mm256_add_pd(_mm256_loadu_pd(fz + j), qz));
+  }
+  double sx= hsum(gx), sy= hsum(gy), sz= hsum(gz);
+  double const s= repel_scalar<double, P, F>(
+      x, y, z, i, j, n, fx, fy, fz, hsum(u), sx, sy, sz);
+  if constexpr(F) {
+    fx[i]+= sx;
+    fy[i]+= sy;
+    fz[i]+= sz;
+  }
+  return s;
+}
+
+
+/// Sum of eight lanes.
+/// @param v  Vector of eight doubles.
+/// @return  Sum of lanes.
+__attribute__((target("avx512f"))) inline double hsum(__m512d v) {
+  alignas(64) double a[8];
+  _mm512_store_pd(a, v);
+  return ((a[0] + a[4]) + (a[1] + a[5])) + ((a[2] + a[6]) + (a[3] + a[7]));
+}
+
+
+/// AVX-512-kernel, processing eight nodes at once.
+/// - Arguments and return-value are described at row_kernel.
+/// - 14-bit estimate of 1/r is refined by two Newton-Raphson steps to full
+///   double precision.
+template<bool P, bool F>
+__attribute__((target("avx512f"))) double repel_row_avx512(
+    double const *x,
+    double const *y,
+    double const *z,
+    int i,
+    int n,
+    double *fx,
+    double *fy,
+    double *fz) {
+  __m512d const xi= _mm512_set1_pd(x[i]);
+  __m512d const yi= _mm512_set1_pd(y[i]);
+  __m512d const zi= _mm512_set1_pd(z[i]);
+  __m512d const three_halves= _mm512_set1_pd(1.5);
+  __m512d const half= _mm512_set1_pd(0.5);
+  __m512d gx= _mm512_setzero_pd(), gy= gx, gz= gx, u= gx;
+  int j= i + 1;
+  for(; j + 8 <= n; j+= 8) {
+    __m512d const dx= _mm512_sub_pd(_mm512_loadu_pd(x + j), xi);
+    __m512d const dy= _mm512_sub_pd(_mm512_loadu_pd(y + j), yi);
+    __m512d const dz= _mm512_sub_pd(_mm512_loadu_pd(z + j), zi);
+    __m512d const r2= _mm512_fmadd_pd(
+        dx, dx, _mm512_fmadd_pd(dy, dy, _mm512_mul_pd(dz, dz)));
+    __m512d const h= _mm512_mul_pd(half, r2);
+    __m512d r= _mm512_maskz_rsqrt14_pd(0xFF, r2);
+    for(int k= 0; k < 2; ++k) {
+      // r <- r * (3/2 - r2 * r * r / 2)
+      r= _mm512_mul_pd(
+          r, _mm512_fnmadd_pd(h, _mm512_mul_pd(r, r), three_halves));
+    }
+    if constexpr(P) u= _mm512_add_pd(u, r);
+    if constexpr(!F) continue;
+    __m512d const q= _mm512_mul_pd(_mm512_mul_pd(r, r), r); // 1/r^3
+    __m512d const qx= _mm512_mul_pd(dx, q);
+    __m512d const qy= _mm512_mul_pd(dy, q);
+    __m512d const qz= _mm512_mul_pd(dz, q);
+    gx= _mm512_sub_pd(gx, qx);
+    gy= _mm512_sub_pd(gy, qy);
+    gz= _mm512_sub_pd(gz, qz);
+    _mm512_storeu_pd(fx + j, _mm512_add_pd(_mm512_loadu_pd(fx + j), qx));
+    _mm512_storeu_pd(fy + j, _mm512_add_pd(_mm512_loadu_pd(fy + j), qy));
+    _mm512_storeu_pd(fz + j, _mm512_add_pd(_mm512_loadu_pd(fz + j), qz));
+  }
+  double sx= hsum(gx), sy= hsum(gy), sz= hsum(gz);
+  double const s= repel_scalar<double, P, F>(
+      x, y, z, i, j, n, fx, fy, fz, hsum(u), sx, sy, sz);
+  if constexpr(F) {
+    fx[i]+= sx;
+    fy[i]+= sy;
+    fz[i]+= sz;
+  }
+  return s;
+}
+
+
+/// Sum of eight single-precision lanes, in double precision.
+/// @param v  Vector of eight floats.
+/// @return  Sum of lanes.
+__attribute__((target("avx2,fma"))) inline double hsum(__m256 v) {
+  return hsum(_mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(v)),
+      _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1))));
+}
+
+
+/// AVX2-kernel in single precision, processing eight nodes at once.
+/// - Arguments and return-value are described at row_kernel.
+/// - Single-precision estimate of 1/r (12 bits) is refined by one
+///   Newton-Raphson step to nearly full single precision.
+/// - Potential is accumulated in double precision, lest its rounding hide
+///   small decrease from line-search.
+template<bool P, bool F>
+__attribute__((target("avx2,fma"))) double repel_row_avx2f(float const *x,
+    float const *y,
+    float const *z,
+    int i,
+    int n,
+    float *fx,
+    float *fy,
+    float *fz) {
+  __m256 const xi= _mm256_set1_ps(x[i]);
+  __m256 const yi= _mm256_set1_ps(y[i]);
+  __m256 const zi= _mm256_set1_ps(z[i]);
+  __m256 const three_halves= _mm256_set1_ps(1.5f);
+  __m256 const half= _mm256_set1_ps(0.5f);
+  __m256 gx= _mm256_setzero_ps(), gy= gx, gz= gx;
+  __m256d u= _mm256_setzero_pd();
+  int j= i + 1;
+  for(; j + 8 <= n; j+= 8) {
+    __m256 const dx= _mm256_sub_ps(_mm256_loadu_ps(x + j), xi);
+    __m256 const dy= _mm256_sub_ps(_mm256_loadu_ps(y + j), yi);
+    __m256 const dz= _mm256_sub_ps(_mm256_loadu_ps(z + j), zi);
+    __m256 const r2= _mm256_fmadd_ps(
+        dx, dx, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dz, dz)));
+    __m256 r= _mm256_rsqrt_ps(r2);
+    // r <- r * (3/2 - r2 * r * r / 2)
+    r= _mm256_mul_ps(r,
+        _mm256_fnmadd_ps(
+            _mm256_mul_ps(half, r2), _mm256_mul_ps(r, r), three_halves));
+    if constexpr(P) {
+      u= _mm256_add_pd(u, _mm256_cvtps_pd(_mm256_castps256_ps128(r)));
+      u= _mm256_add_pd(u, _mm256_cvtps_pd(_mm256_extractf128_ps(r, 1)));
+    }
+    if constexpr(!F) continue;
+    __m256 const q= _mm256_mul_ps(_mm256_mul_ps(r, r), r); // 1/r^3
+    __m256 const qx= _mm256_mul_ps(dx, q);
+    __m256 const qy= _mm256_mul_ps(dy, q);
+    __m256 const qz= _mm256_mul_ps(dz, q);
+    gx= _mm256_sub_ps(gx, qx);
+    gy= _mm256_sub_ps(gy, qy);
+    gz= _mm256_sub_ps(gz, qz);
+    _mm256_storeu_ps(fx + j, _mm256_add_ps(_mm256_loadu_ps(fx + j), qx));
+    _mm256_storeu_ps(fy + j, _mm256_add_ps(_mm256_loadu_ps(fy + j), qy));
+    _mm256_storeu_ps(fz + j, _mm256_add_ps(_mm256_loadu_ps(fz + j), qz));
+  }
+  float sx= hsum(gx), sy= hsum(gy), sz= hsum(gz);
+  double const s= repel_scalar<float, P, F>(
+      x, y, z, i, j, n, fx, fy, fz, hsum(u), sx, sy, sz);
+  if constexpr(F) {
+    fx[i]+= sx;
+    fy[i]+= sy;
+    fz[i]+= sz;
+  }
+  return s;
+}
+
+
+/// Sum of sixteen single-precision lanes, in double precision.
+/// @param v  Vector of sixteen floats.
+/// @return  Sum of lanes.
+__attribute__((target("avx512f"))) inline double hsum(__m512 v) {
+  alignas(64) float a[16];
+  _mm512_store_ps(a, v);
+  double s= 0.0;
+  for(float e: a) s+= e;
+  return s;
+}
+
+
+/// AVX-512-kernel in single precision, processing sixteen nodes at once.
+/// - Arguments and return-value are described at row_kernel.
+/// - 14-bit estimate of 1/r is refined by one Newton-Raphson step to full
+///   single precision.
+/// - Potential is accumulated in double precision, as by repel_row_avx2f().
+template<bool P, bool F>
+__attribute__((target("avx512f"))) double repel_row_avx512f(float const *x,
+    float const *y,
+    float const *z,
+    int i,
+    int n,
+    float *fx,
+    float *fy,
+    float *fz) {
+  __m512 const xi= _mm512_set1_ps(x[i]);
+  __m512 const yi= _mm512_set1_ps(y[i]);
+  __m512 const zi= _mm512_set1_ps(z[i]);
+  __m512 const three_halves= _mm512_set1_ps(1.5f);
+  __m512 const half= _mm512_set1_ps(0.5f);
+  __m512 gx= _mm512_setzero_ps(), gy= gx, gz= gx;
+  __m512d u= _mm512_setzero_pd();
+  int j= i + 1;
+  for(; j + 16 <= n; j+= 16) {
+    __m512 const dx= _mm512_sub_ps(_mm512_loadu_ps(x + j), xi);
+    __m512 const dy= _mm512_sub_ps(_mm512_loadu_ps(y + j), yi);
+    __m512 const dz= _mm512_sub_ps(_mm512_loadu_ps(z + j), zi);
+    __m512 const r2= _mm512_fmadd_ps(
+        dx, dx, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dz, dz)));
+    __m512 r= _mm512_maskz_rsqrt14_ps(0xFFFF, r2);
+    // r <- r * (3/2 - r2 * r * r / 2)
+    r= _mm512_mul_ps(r,
+        _mm512_fnmadd_ps(
+            _mm512_mul_ps(half, r2), _mm512_mul_ps(r, r), three_halves));
+    if constexpr(P) {
+      // Zero-masked forms, like rsqrt14 above, take no undefined source,
+      // which GCC would report as maybe uninitialized.
+      __m512d const rd= _mm512_castps_pd(r);
+      __m256 const lo=
+          _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, rd, 0));
+      __m256 const hi=
+          _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, rd, 1));
+      u= _mm512_add_pd(u, _mm512_maskz_cvtps_pd(0xFF, lo));
+      u= _mm512_add_pd(u, _mm512_maskz_cvtps_pd(0xFF, hi));
+    }
+    if constexpr(!F) continue;
+    __m512 const q= _mm512_mul_ps(_mm512_mul_ps(r, r), r); // 1/r^3
+    __m512 const qx= _mm512_mul_ps(dx, q);
+    __m512 const qy= _mm512_mul_ps(dy, q);
+    __m512 const qz= _mm512_mul_ps(dz, q);
+    gx= _mm512_sub_ps(gx, qx);
+    gy= _mm512_sub_ps(gy, qy);
+    gz= _mm512_sub_ps(gz, qz);
+    _mm512_storeu_ps(fx + j, _mm512_add_ps(_mm512_loadu_ps(fx + j), qx));
+    _mm512_storeu_ps(fy + j, _mm512_add_ps(_mm512_loadu_ps(fy + j), qy));
+    _mm512_storeu_ps(fz + j, _mm512_add_ps(_mm512_loadu_ps(fz + j), qz));
+  }
+  float sx= hsum(gx), sy= hsum(gy), sz= hsum(gz);
+  double const s= repel_scalar<float, P, F>(
+      x, y, z, i, j, n, fx, fy, fz, hsum(u), sx, sy, sz);
+  if constexpr(F) {
+    fx[i]+= sx;
+    fy[i]+= sy;
+    fz[i]+= sz;
+  }
+  return s;
+}
+
+/// AVX2-kernel for product of Hessian with direction, processing four nodes
+/// at once.
+/// - Arguments are described at hess_kernel.
+/// - 1/r is refined from single-precision estimate, as by repel_row_avx2().
+__attribute__((target("avx2,fma"))) void hess_row_avx2(double const *x,
+    double const *y,
+    double const *z,
+    double const *vx,
+    double const *vy,
+    double const *vz,
+    int i,
+    int n,
+    double *hx,
+    double *hy,
+    double *hz) {
+  __m256d const xi= _mm256_set1_pd(x[i]);
+  __m256d const yi= _mm256_set1_pd(y[i]);
+  __m256d const zi= _mm256_set1_pd(z[i]);
+  __m256d const vxi= _mm256_set1_pd(vx[i]);
+  __m256d const vyi= _mm256_set1_pd(vy[i]);
+  __m256d const vzi= _mm256_set1_pd(vz[i]);
+  __m256d const three_halves= _mm256_set1_pd(1.5);
+  __m256d const half= _mm256_set1_pd(0.5);
+  __m256d const three= _mm256_set1_pd(3.0);
+  __m256d gx= _mm256_setzero_pd(), gy= gx, gz= gx;
+  int j= i + 1;
+  for(; j + 4 <= n; j+= 4) {
+    __m256d const dx= _mm256_sub_pd(_mm256_loadu_pd(x + j), xi);
+    __m256d const dy= _mm256_sub_pd(_mm256_loadu_pd(y + j), yi);
+    __m256d const dz= _mm256_sub_pd(_mm256_loadu_pd(z + j), zi);
+    __m256d const wx= _mm256_sub_pd(_mm256_loadu_pd(vx + j), vxi);
+    __m256d const wy= _mm256_sub_pd(_mm256_loadu_pd(vy + j), vyi);
+    __m256d const wz= _mm256_sub_pd(_mm256_loadu_pd(vz + j), vzi);
+    __m256d const r2= _mm256_fmadd_pd(
+        dx, dx, _mm256_fmadd_pd(dy, dy, _mm256_mul_pd(dz, dz)));
+    __m256d const h= _mm256_mul_pd(half, r2);
+    __m256d r= _mm256_cvtps_pd(_mm_rsqrt_ps(_mm256_cvtpd_ps(r2)));
+    for(int k= 0; k < 3; ++k) {
+      r= _mm256_mul_pd(
+          r, _mm256_fnmadd_pd(h, _mm256_mul_pd(r, r), three_halves));
+    }
+    __m256d const s= _mm256_mul_pd(r, r); // 1/r^2
+    __m256d const q= _mm256_mul_pd(s, r); // 1/r^3
+    __m256d const dw= _mm256_fmadd_pd(
+        dx, wx, _mm256_fmadd_pd(dy, wy, _mm256_mul_pd(dz, wz)));
+    __m256d const t= _mm256_mul_pd(_mm256_mul_pd(three, s), dw);
+    __m256d const ax= _mm256_mul_pd(q, _mm256_fmsub_pd(t, dx, wx));
+    __m256d const ay= _mm256_mul_pd(q, _mm256_fmsub_pd(t, dy, wy));
+    __m256d const az= _mm256_mul_pd(q, _mm256_fmsub_pd(t, dz, wz));
+    gx= _mm256_sub_pd(gx, ax);
+    gy= _mm256_sub_pd(gy, ay);
+    gz= _mm256_sub_pd(gz, az);
+    _mm256_storeu_pd(hx + j, _mm256_add_pd(_mm256_loadu_pd(hx + j), ax));
+    _mm256_storeu_pd(hy + j, _mm256_add_pd(_mm256_loadu_pd(hy + j), ay));
+    _mm256_storeu_pd(hz + j, _mm256_add_pd(_mm256_loadu_pd(hz + j), az));
+  }
+  double sx= hsum(gx), sy= hsum(gy), sz= hsum(gz);
+  hess_scalar(x, y, z, vx, vy, vz, i, j, n, hx, hy, hz, sx, sy, sz);
+  hx[i]+= sx;
+  hy[i]+= sy;
+  hz[i]+= sz;
+}
+
+
+/// AVX-512-kernel for product of Hessian with direction, processing eight
+/// nodes at once.
+/// - Arguments are described at hess_kernel.
+/// - 1/r is refined from 14-bit estimate, as by repel_row_avx512().
+__attribute__((target("avx512f"))) void hess_row_avx512(double const *x,
+    double const *y,
+    double const *z,
+    double const *vx,
+    double const *vy,
+    double const *vz,
+    int i,
+    int n,
+    double *hx,
+    double *hy,
+    double *hz) {
+  __m512d const xi= _mm512_set1_pd(x[i]);
+  __m512d const yi= _mm512_set1_pd(y[i]);
+  __m512d const zi= _mm512_set1_pd(z[i]);
+  __m512d const vxi= _mm512_set1_pd(vx[i]);
+  __m512d const vyi= _mm512_set1_pd(vy[i]);
+  __m512d const vzi= _mm512_set1_pd(vz[i]);
+  __m512d const three_halves= _mm512_set1_pd(1.5);
+  __m512d const half= _mm512_set1_pd(0.5);
+  __m512d const three= _mm512_set1_pd(3.0);
+  __m512d gx= _mm512_setzero_pd(), gy= gx, gz= gx;
+  int j= i + 1;
+  for(; j + 8 <= n; j+= 8) {
+    __m512d const dx= _mm512_sub_pd(_mm512_loadu_pd(x + j), xi);
+    __m512d const dy= _mm512_sub_pd(_mm512_loadu_pd(y + j), yi);
+    __m512d const dz= _mm512_sub_pd(_mm512_loadu_pd(z + j), zi);
+    __m512d const wx= _mm512_sub_pd(_mm512_loadu_pd(vx + j), vxi);
+    __m512d const wy= _mm512_sub_pd(_mm512_loadu_pd(vy + j), vyi);
+    __m512d const wz= _mm512_sub_pd(_mm512_loadu_pd(vz + j), vzi);
+    __m512d const r2= _mm512_fmadd_pd(
+        dx, dx, _mm512_fmadd_pd(dy, dy, _mm512_mul_pd(dz, dz)));
+    __m512d const h= _mm512_mul_pd(half, r2);
+    __m512d r= _mm512_maskz_rsqrt14_pd(0xFF, r2);
+    for(int k= 0; k < 2; ++k) {
+      r= _mm512_mul_pd(
+          r, _mm512_fnmadd_pd(h, _mm512_mul_pd(r, r), three_halves));
+    }
+    __m512d const s= _mm512_mul_pd(r, r); // 1/r^2
+    __m512d const q= _mm512_mul_pd(s, r); // 1/r^3
+    __m512d const dw= _mm512_fmadd_pd(
+        dx, wx, _mm512_fmadd_pd(dy, wy, _mm512_mul_pd(dz, wz)));
+    __m512d const t= _mm512_mul_pd(_mm512_mul_pd(three, s), dw);
+    __m512d const ax= _mm512_mul_pd(q, _mm512_fmsub_pd(t, dx, wx));
+    __m512d const ay= _mm512_mul_pd(q, _mm512_fmsub_pd(t, dy, wy));
+    __m512d const az= _mm512_mul_pd(q, _mm512_fmsub_pd(t, dz, wz));
+    gx= _mm512_sub_pd(gx, ax);
+    gy= _mm512_sub_pd(gy, ay);
+    gz= _mm512_sub_pd(gz, az);
+    _mm512_storeu_pd(hx + j, _mm512_add_pd(_mm512_loadu_pd(hx + j), ax));
+    _mm512_storeu_pd(hy + j, _mm512_add_pd(_mm512_loadu_pd(hy + j), ay));
+    _mm512_storeu_pd(hz + j, _mm512_add_pd(_mm512_loadu_pd(hz + j), az));
+  }
+  double sx= hsum(gx), sy= hsum(gy), sz= hsum(gz);
+  hess_scalar(x, y, z, vx, vy, vz, i, j, n, hx, hy, hz, sx, sy, sz);
+  hx[i]+= sx;
+  hy[i]+= sy;
+  hz[i]+= sz;
+}
+
+#endif // MODGRAPH_X86_KERNELS
+
+
+/// Kernels best suited to this CPU, and name of their instruction set.
+struct kernel_choice {
+  /// Kernel for each value of quantities (element 0 unused).
+  row_kernel<double> kernel[4]= {nullptr,
+      repel_row_scalar<double, true, false>,
+      repel_row_scalar<double, false, true>,
+      repel_row_scalar<double, true, true>};
+
+  /// Single-precision kernel for each value of quantities.
+  row_kernel<float> kernel_f[4]= {nullptr,
+      repel_row_scalar<float, true, false>,
+      repel_row_scalar<float, false, true>,
+      repel_row_scalar<float, true, true>};
+
+  hess_kernel hess= hess_row_scalar; ///< Kernel for product with Hessian.
+
+  char const *isa= "scalar"; ///< Name of instruction set used by kernels.
+
+  /// Detect features of CPU, and choose kernels.
+  kernel_choice() {
+#ifdef MODGRAPH_X86_KERNELS
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) {
+      kernel[POTENTIAL]= repel_row_avx512<true, false>;
+      kernel[FORCES]= repel_row_avx512<false, true>;
+      kernel[BOTH]= repel_row_avx512<true, true>;
+      kernel_f[POTENTIAL]= repel_row_avx512f<true, false>;
+      kernel_f[FORCES]= repel_row_avx512f<false, true>;
+      kernel_f[BOTH]= repel_row_avx512f<true, true>;
+      hess= hess_row_avx512;
+      isa= "avx512";
+    } else if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      kernel[POTENTIAL]= repel_row_avx2<true, false>;
+      kernel[FORCES]= repel_row_avx2<false, true>;
+      kernel[BOTH]= repel_row_avx2<true, true>;
+      kernel_f[POTENTIAL]= repel_row_avx2f<true, false>;
+      kernel_f[FORCES]= repel_row_avx2f<false, true>;
+      kernel_f[BOTH]= repel_row_avx2f<true, true>;
+      hess= hess_row_avx2;
+      isa= "avx2";
+    }
+#endif
+  }
+};
+
+
+/// Kernel best suited to this CPU, chosen once on first use.
+/// @return  Reference to choice of kernel.
+kernel_choice const &choice() {
+  static kernel_choice const c;
+  return c;
+}
+
+
+double repel_row(soa const &p, int i, soa &f, quantities q) {
+  return choice().kernel[q](p.col(0).data(),
+      p.col(1).data(),
+      p.col(2).data(),
+      i,
+      int(p.rows()),
+      f.col(0).data(),
+      f.col(1).data(),
+      f.col(2).data());
+}
+
+
+double repel_row(soa_f const &p, int i, soa_f &f, quantities q) {
+  return choice().kernel_f[q](p.col(0).data(),
+      p.col(1).data(),
+      p.col(2).data(),
+      i,
+      int(p.rows()),
+      f.col(0).data(),
+      f.col(1).data(),
+      f.col(2).data());
+}
+
+
+void hess_row(soa const &p, soa const &v, int i, soa &h) {
+  choice().hess(p.col(0).data(),
+      p.col(1).data(),
+      p.col(2).data(),
+      v.col(0).data(),
+      v.col(1).data(),
+      v.col(2).data(),
+      i,
+      int(p.rows()),
+      h.col(0).data(),
+      h.col(1).data(),
+      h.col(2).data());
+}
+
+
+char const *repel_isa() { return choice().isa; }
+
+
+} // namespace modgraph
+
+// EOF
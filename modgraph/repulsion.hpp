@@ -0,0 +1,82 @@
+/// @file       repulsion.hpp
+/// @brief      Declaration of modgraph::repel_row(), modgraph::hess_row(),
+///             and related definitions.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include <eigen3/Eigen/Core> // Matrix
+
+namespace modgraph {
+
+
+/// Structure of arrays for three-dimensional vector associated with each of
+/// N nodes.
+/// - Column 0 holds every x-component contiguously; column 1, every
+///   y-component; and column 2, every z-component.
+/// @tparam T  Scalar type, either double or float.
+template<typename T> using soa_of= Eigen::Matrix<T, Eigen::Dynamic, 3>;
+
+using soa= soa_of<double>; ///< Structure of arrays in double precision.
+using soa_f= soa_of<float>; ///< Structure of arrays in single precision.
+
+
+/// Quantities computed by evaluation of potential and forces.
+enum quantities {
+  POTENTIAL= 1, ///< Only scalar potential.
+  FORCES= 2, ///< Only forces.
+  BOTH= POTENTIAL | FORCES ///< Both potential and forces, in one pass.
+};
+
+
+/// Add universal inverse-square repulsion between Node `i` and every Node `j`
+/// such that `i < j < N`.
+/// - Force felt by each node of pair is accumulated into `f`, unless `q` be
+///   POTENTIAL, in which case `f` is untouched.
+/// - On x86-64, repel_row() uses AVX-512 or AVX2 when CPU supports it, with
+///   reciprocal square root refined by Newton-Raphson to full double
+///   precision; otherwise, it uses plain scalar arithmetic.
+/// @param p  Position of each of N nodes.
+/// @param i  Offset of node.
+/// @param f  Force felt by each of N nodes, to be incremented.
+/// @param q  Quantities to compute.
+/// @return  Sum of 1/r over every pair, or zero if `q` be FORCES.
+double repel_row(soa const &p, int i, soa &f, quantities q= BOTH);
+
+
+/// Add universal inverse-square repulsion, as by repel_row() above, but with
+/// arithmetic for each pair in single precision.
+/// - SIMD-width is twice that of double precision, and memory-traffic is
+///   half.
+/// - Sum over row is returned in double precision, but force on each node is
+///   accumulated in single precision; so caller should fold `f` into
+///   double-precision accumulator every few rows.
+/// @param p  Position of each of N nodes.
+/// @param i  Offset of node.
+/// @param f  Force felt by each of N nodes, to be incremented.
+/// @param q  Quantities to compute.
+/// @return  Sum of 1/r over every pair, or zero if `q` be FORCES.
+double repel_row(soa_f const &p, int i, soa_f &f, quantities q= BOTH);
+
+
+/// Add product of Hessian of universal repulsion with direction `v`, over
+/// every pair of Node `i` with Node `j` such that `i < j < N`.
+/// - Hessian is that of sum of 1/r, computed analytically and never formed;
+///   so truncated-Newton method gets each product at about cost of one
+///   evaluation of forces.
+/// - Kernel uses same instruction set as repel_row() in double precision.
+/// @param p  Position of each of N nodes.
+/// @param v  Direction at each of N nodes.
+/// @param i  Offset of node.
+/// @param h  Product at each of N nodes, to be incremented.
+void hess_row(soa const &p, soa const &v, int i, soa &h);
+
+
+/// Name of instruction set used by repel_row() on this CPU.
+/// @return  "avx512", "avx2", or "scalar".
+char const *repel_isa();
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,67 @@
+/// @file       scheduler.cpp
+/// @brief      Definition of modgraph::scheduler.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "scheduler.hpp"
+#include <exception> // exception_ptr
+#include <thread> // thread
+
+using std::function;
+using std::lock_guard;
+using std::mutex;
+using std::vector;
+
+
+namespace modgraph {
+
+
+bool scheduler::take(int w, function<void()> &task) {
+  int const n= int(queues_.size());
+  for(int k= 0; k < n; ++k) {
+    queue &q= queues_[(w + k) % n]; // Own queue first.
+    lock_guard<mutex> lock(q.mutex);
+    if(!q.tasks.empty()) {
+      task= std::move(q.tasks.front());
+      q.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void scheduler::work(int w) {
+  function<void()> task;
+  while(take(w, task)) task();
+}
+
+
+scheduler::scheduler(int workers): queues_(workers < 1 ? 1 : workers) {}
+
+
+void scheduler::run(vector<function<void()>> tasks) {
+  int const n= int(queues_.size());
+  std::exception_ptr error;
+  mutex error_mutex;
+  for(unsigned i= 0; i < tasks.size(); ++i) {
+    auto guarded= [t= std::move(tasks[i]), &error, &error_mutex] {
+      try {
+        t();
+      } catch(...) {
+        lock_guard<mutex> lock(error_mutex);
+        if(!error) error= std::current_exception();
+      }
+    };
+    queues_[i % n].tasks.push_back(std::move(guarded));
+  }
+  vector<std::thread> threads;
+  for(int w= 1; w < n; ++w) threads.emplace_back(&scheduler::work, this, w);
+  work(0);
+  for(auto &t: threads) t.join();
+  if(error) std::rethrow_exception(error);
+}
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,58 @@
+/// @file       scheduler.hpp
+/// @brief      Declaration of modgraph::scheduler.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include <deque> // deque
+#include <functional> // function
+#include <mutex> // mutex
+#include <vector> // vector
+
+namespace modgraph {
+
+
+/// Work-stealing scheduler for independent tasks of unequal size.
+/// - Tasks are dealt, in order given, round-robin onto one queue per worker.
+/// - Each worker takes tasks from front of its own queue; when that be
+///   empty, worker steals from front of another worker's queue.
+/// - So, if tasks be given in order of decreasing size, then largest task
+///   not yet started is always taken next, and small tasks fill in tail of
+///   run.
+class scheduler {
+  /// Queue of tasks belonging to one worker.
+  struct queue {
+    std::mutex mutex; ///< Guard for tasks.
+    std::deque<std::function<void()>> tasks; ///< Tasks not yet started.
+  };
+
+  std::vector<queue> queues_; ///< One queue per worker.
+
+  /// Take next task for Worker `w`, either from its own queue or from that of
+  /// another worker.
+  /// @param w  Index of worker.
+  /// @param task  On return, task to run, if any.
+  /// @return  False if every queue be empty.
+  bool take(int w, std::function<void()> &task);
+
+  /// Loop run by each worker.
+  /// @param w  Index of worker.
+  void work(int w);
+
+public:
+  /// Initialize queues.
+  /// @param workers  Number of workers.
+  scheduler(int workers);
+
+  /// Run every task, and wait for every task to finish.
+  /// - Calling thread is one of workers.
+  /// - If any task throw, then remaining tasks still run, and first exception
+  ///   is rethrown after every worker finishes.
+  /// @param tasks  Tasks, preferably in order of decreasing size.
+  void run(std::vector<std::function<void()>> tasks);
+};
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,232 @@
+/// @file       service.cpp
+/// @brief      Definition of modgraph::service.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "service.hpp"
+#include <algorithm> // max
+#include <cstdlib> // abs
+#include <cerrno> // errno
+#include <csignal> // signal, SIGPIPE
+#include <cstring> // strerror, strncpy
+#include <iostream> // cerr, cout, endl
+#include <sstream> // istringstream
+#include <stdexcept> // exception
+#include <sys/socket.h> // socket, bind, listen, accept, setsockopt
+#include <sys/time.h> // timeval
+#include <sys/un.h> // sockaddr_un
+#include <unistd.h> // close, unlink
+
+using std::string;
+
+
+namespace modgraph {
+
+
+service::service(options const &o, unsigned capacity):
+    opts_(o), capacity_(std::max(capacity, 1u)) {
+  if(opts_.progress_path.empty()) opts_.progress_format= "none";
+  if(opts_.archive.empty()) return;
+  archive_.reset(new archive_reader(opts_.archive));
+  layout_key const k{0,
+      opts_.edge_attract,
+      opts_.sum_attract,
+      opts_.factor_attract,
+      opts_.theta};
+  if(!(archive_->params() == k)) {
+    std::cerr << "archive holds layouts for other parameters; ignored"
+              << std::endl;
+    archive_.reset();
+  }
+}
+
+
+bool service::handle(string const &line, std::FILE *out) {
+  std::istringstream is(line);
+  string word;
+  if(!(is >> word)) return true; // Blank line.
+  if(word == "quit") return false;
+  if(word == "stats") {
+    std::fprintf(out, "stats %zu %d %d\n", lru_.size(), hits_, misses_);
+    return true;
+  }
+  int m= 0;
+  unsigned seed= opts_.seed;
+  std::istringstream ms(word);
+  if(!(ms >> m) || !(ms >> std::ws).eof() || m < 2) {
+    std::fprintf(out, "error illegal modulus '%s'\n", word.c_str());
+    return true;
+  }
+  if(m > MAX_MODULUS) {
+    std::fprintf(out, "error modulus %d exceeds %d\n", m, MAX_MODULUS);
+    return true;
+  }
+  if(is >> word) {
+    std::istringstream ss(word);
+    if(!(ss >> seed) || !(ss >> std::ws).eof() || (is >> word)) {
+      std::fprintf(out, "error illegal seed in '%s'\n", line.c_str());
+      return true;
+    }
+  }
+  archived_layout a;
+  if(archive_ && seed == opts_.seed && archive_->find(m, a)) {
+    ++hits_;
+    std::fprintf(out,
+        "ok %d %d %.17g %d %d 1\n",
+        m,
+        m,
+        a.record->potential,
+        a.record->iterations,
+        a.record->converged);
+    for(int i= 0; i < m; ++i) {
+      float const *p= a.positions + 3 * i;
+      std::fprintf(out, "%d %.9g %.9g %.9g\n", a.next[i], p[0], p[1], p[2]);
+    }
+    return true;
+  }
+  auto e= lru_.begin();
+  while(e != lru_.end() && e->g->modulus != m) ++e;
+  bool const hit= (e != lru_.end() && e->seed == seed);
+  try {
+    if(e == lru_.end()) {
+      // Tables and springs are built once per cached modulus.
+      options o= opts_;
+      o.seed= seed;
+      std::unique_ptr<graph> g(new graph(m, o));
+      auto near= lru_.end(); // Cached layout of nearest modulus.
+      for(auto c= lru_.begin(); opts_.incremental && c != lru_.end(); ++c) {
+        if(c->seed != seed) continue;
+        if(near == lru_.end() || std::abs(c->g->modulus - m) <
+                                     std::abs(near->g->modulus - m)) {
+          near= c;
+        }
+      }
+      if(near != lru_.end()) {
+        minimizer const &p= near->g->layout_minimizer();
+        g->layout_from(p.spring_constants(), p.positions());
+      } else {
+        g->layout();
+      }
+      lru_.push_front({std::move(g), seed});
+      if(lru_.size() > capacity_) lru_.pop_back();
+    } else {
+      lru_.splice(lru_.begin(), lru_, e);
+      if(!hit) {
+        lru_.front().g->relayout(seed);
+        lru_.front().seed= seed;
+      }
+    }
+  } catch(char const *s) {
+    if(e != lru_.end()) lru_.pop_front(); // Layout may be incomplete.
+    std::fprintf(out, "error modulus %d: %s\n", m, s);
+    return true;
+  } catch(std::exception const &x) {
+    // Failure of one request, like std::bad_alloc, must not end service.
+    if(e != lru_.end()) lru_.pop_front();
+    std::fprintf(out, "error modulus %d: %s\n", m, x.what());
+    return true;
+  }
+  if(hit) {
+    ++hits_;
+  } else {
+    ++misses_;
+  }
+  graph const &g= *lru_.front().g;
+  minimizer const &mz= g.layout_minimizer();
+  auto const &pos= mz.positions();
+  std::fprintf(out,
+      "ok %d %d %.17g %d %d %d\n",
+      m,
+      int(pos.cols()),
+      mz.potential(),
+      mz.iterations(),
+      int(mz.converged()),
+      int(hit));
+  for(int i= 0; i < pos.cols(); ++i) {
+    std::fprintf(out,
+        "%d %.17g %.17g %.17g\n",
+        g.next(i),
+        pos(0, i),
+        pos(1, i),
+        pos(2, i));
+  }
+  return true;
+}
+
+
+bool service::serve(std::FILE *in, std::FILE *out) {
+  string line;
+  for(int c; (c= std::fgetc(in)) != EOF;) {
+    if(c != '\n') {
+      line+= char(c);
+      continue;
+    }
+    bool const more= handle(line, out);
+    std::fflush(out);
+    if(!more) return false;
+    line.clear();
+  }
+  // Last line without newline is answered, but not line cut off by error
+  // (like timeout of idle client).
+  if(!line.empty() && !std::ferror(in)) handle(line, out);
+  std::fflush(out);
+  return true;
+}
+
+
+void service::serve_stdin() {
+  // Replies alone go to stdout; every message from layout goes to stderr.
+  std::streambuf *const cout_buf= std::cout.rdbuf(std::cerr.rdbuf());
+  try {
+    serve(stdin, stdout);
+  } catch(...) {
+    std::cout.rdbuf(cout_buf);
+    throw;
+  }
+  std::cout.rdbuf(cout_buf);
+}
+
+
+void service::serve_socket(string const &path) {
+  sockaddr_un addr= {};
+  addr.sun_family= AF_UNIX;
+  if(path.size() >= sizeof(addr.sun_path)) throw "socket-path too long";
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  int const fd= socket(AF_UNIX, SOCK_STREAM, 0);
+  if(fd < 0) throw "cannot create socket";
+  unlink(path.c_str());
+  if(bind(fd, (sockaddr const *)&addr, sizeof(addr)) || listen(fd, 8)) {
+    std::cerr << path << ": " << std::strerror(errno) << std::endl;
+    close(fd);
+    throw "cannot listen on socket";
+  }
+  // Client that hangs up early must not kill service.
+  std::signal(SIGPIPE, SIG_IGN);
+  std::cout << "serving on " << path << std::endl;
+  for(;;) {
+    int const c= accept(fd, nullptr, nullptr);
+    if(c < 0) {
+      if(errno == EINTR) continue;
+      close(fd);
+      throw "cannot accept connection";
+    }
+    // Idle client is disconnected, so that it cannot block other clients
+    // forever.
+    timeval const t{IDLE_SECONDS, 0};
+    setsockopt(c, SOL_SOCKET, SO_RCVTIMEO, &t, sizeof(t));
+    setsockopt(c, SOL_SOCKET, SO_SNDTIMEO, &t, sizeof(t));
+    std::FILE *in= fdopen(c, "r");
+    std::FILE *out= fdopen(dup(c), "w");
+    if(in && out) serve(in, out);
+    if(out) std::fclose(out);
+    if(in) {
+      std::fclose(in);
+    } else {
+      close(c);
+    }
+  }
+}
+
+
+} // namespace modgraph
+
+// EOF
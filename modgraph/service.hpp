@@ -0,0 +1,105 @@
+/// @file       service.hpp
+/// @brief      Declaration of modgraph::service.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+///
+/// Long-running service answers requests for layout, one per line, over
+/// stdin or over Unix-domain socket, and streams positions back without
+/// touching disk.
+/// - Request "M" or "M seed" lays out modulus M (from random positions drawn
+///   from seed, if given); M may not exceed service::MAX_MODULUS.
+/// - Reply begins with line "ok M N potential iterations converged hit",
+///   in which converged and hit are each 0 or 1, and is followed by N lines,
+///   one per node, each "next x y z".
+/// - Request "stats" is answered by "stats entries hits misses".
+/// - Request "quit" closes connection (or ends service on stdin).
+/// - Malformed or failed request is answered by "error message".
+/// - With options::incremental, new modulus is laid out from cached layout
+///   of nearest modulus.
+/// - Request for modulus in archive (options::archive) is answered from
+///   mapping of archive, with single-precision positions, as hit.
+
+#pragma once
+
+#include "archive.hpp" // archive_reader
+#include "graph.hpp" // graph
+#include "options.hpp" // options
+#include <cstdio> // FILE
+#include <list> // list
+#include <memory> // unique_ptr
+#include <string> // string
+
+namespace modgraph {
+
+
+/// Service that keeps graph (tables, springs, buffers, and GSL-workspace)
+/// and latest layout of each recently requested modulus.
+/// - Graphs are kept in least-recently-used order; least recently used is
+///   evicted when there be more than capacity.
+/// - Request for same modulus and seed as cached layout is answered without
+///   minimization; request for same modulus with different seed minimizes
+///   again with cached graph.
+class service {
+public:
+  /// Largest modulus that may be requested, lest single request exhaust
+  /// memory of service.
+  static constexpr int MAX_MODULUS= 1 << 20;
+
+  /// Seconds for which socket-client may leave service waiting for request
+  /// (or for reading of reply) before being disconnected.
+  static constexpr int IDLE_SECONDS= 30;
+
+private:
+  /// Cached graph and seed of its latest layout.
+  struct entry {
+    std::unique_ptr<graph> g; ///< Graph, already laid out.
+    unsigned seed; ///< Seed of layout.
+  };
+
+  options opts_; ///< Options common to every layout.
+  unsigned const capacity_; ///< Largest number of cached graphs.
+  std::list<entry> lru_; ///< Cached graphs, most recently used first.
+  std::unique_ptr<archive_reader> archive_; ///< Archive, if any.
+  int hits_= 0; ///< Number of requests answered from cache.
+  int misses_= 0; ///< Number of requests that needed minimization.
+
+  /// Answer one request.
+  /// @param line  Request, without newline.
+  /// @param out  Sink for reply.
+  /// @return  False if request were "quit".
+  bool handle(std::string const &line, std::FILE *out);
+
+  /// Answer every request on one stream, until end of input or "quit".
+  /// @param in  Source of requests.
+  /// @param out  Sink for replies.
+  /// @return  False if last request were "quit".
+  bool serve(std::FILE *in, std::FILE *out);
+
+public:
+  /// Initialize empty cache.
+  /// - Progress of minimization is not reported, unless options name file
+  ///   for it, lest it be mixed with replies.
+  /// - Archive for other parameters of potential is ignored.
+  /// @param o  Options common to every layout.
+  /// @param capacity  Largest number of cached graphs (at least 1).
+  service(options const &o, unsigned capacity);
+
+  /// Answer requests on stdin, with replies on stdout, until end of input or
+  /// "quit".
+  /// - Every other output to std::cout is sent to std::cerr meanwhile.
+  void serve_stdin();
+
+  /// Answer requests on Unix-domain socket, one connection at a time, until
+  /// process be killed.
+  /// - Connections are not served concurrently: every other client waits
+  ///   while one connection be open, and while its layout be minimized.
+  /// - Client that sends nothing (or reads nothing) for IDLE_SECONDS is
+  ///   disconnected, so that idle client cannot block others forever.
+  /// - Stale socket-file at `path` is removed first.
+  /// @param path  Path of socket.
+  void serve_socket(std::string const &path);
+};
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,139 @@
+/// @file       springs.cpp
+/// @brief      Definition of modgraph::springs.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "springs.hpp"
+#include "graph.hpp" // squares
+#include <algorithm> // sort, unique
+#include <vector> // vector
+
+using std::vector;
+
+
+namespace modgraph {
+
+
+/// Nodes j > i that might share spring with Node i, in increasing order.
+/// - Candidate is either node joined to `i` by directed edge, node of nonzero
+///   weight, or node whose sum with `i` has nonzero weight.
+/// - If Node i itself have nonzero weight, then every j > i is attracted.
+/// - Candidates are found only for enabled rules.
+/// @param g  Reference to tables of graph.
+/// @param i  Offset of node.
+/// @param edge  True if attraction along edge be enabled.
+/// @param sum  True if attraction by sum be enabled.
+/// @param factor  True if attraction by factor be enabled.
+/// @param c  On return, candidates.
+void candidates(squares const &g,
+    int i,
+    bool edge,
+    bool sum,
+    bool factor,
+    vector<int> &c) {
+  int const m= g.modulus;
+  c.clear();
+  if(factor && g.weight(i) != 0.0) {
+    for(int j= i + 1; j < m; ++j) c.push_back(j);
+    return;
+  }
+  if(edge) {
+    if(g.next(i) > i) c.push_back(g.next(i));
+    for(int j: g.predecessors(i)) {
+      if(j > i) c.push_back(j);
+    }
+  }
+  for(int r: g.weighted()) {
+    if(factor && r > i) c.push_back(r); // Node of nonzero weight.
+    int const j= (r >= i ? r - i : r - i + m); // Partner whose sum be r.
+    if(sum && j > i) c.push_back(j);
+  }
+  std::sort(c.begin(), c.end());
+  c.erase(std::unique(c.begin(), c.end()), c.end());
+}
+
+
+spring_pattern::spring_pattern(
+    squares const &g, bool edge, bool sum, bool factor):
+    outer_({0}) {
+  int const m= g.modulus;
+  vector<int> c; // Candidates for current row.
+  for(int i= 0; i < m; ++i) {
+    candidates(g, i, edge, sum, factor, c);
+    for(int j: c) {
+      // Pair joined by directed edge, even by cycle of length two, is
+      // attracted once.  Attraction by sum is proportional to weight of
+      // (i + j) % m, and attraction by factor to weight of each node.
+      int const s= (i + j < m ? i + j : i + j - m);
+      inner_.push_back(j);
+      edge_.push_back(g.next(i) == j || g.next(j) == i);
+      sum_.push_back(g.weight(s));
+      factor_.push_back(g.weight(i) + g.weight(j));
+    }
+    outer_.push_back(inner_.size());
+  }
+}
+
+
+springs::springs(squares const &g, double edge, double sum, double factor):
+    springs(spring_pattern(g, edge != 0.0, sum != 0.0, factor != 0.0),
+        edge,
+        sum,
+        factor) {}
+
+
+springs::springs(
+    spring_pattern const &p, double edge, double sum, double factor) {
+  int const m= p.outer_.size() - 1;
+  // Disabled rule contributes nothing.
+  double const ke= (edge != 0.0 ? 1.0 / edge : 0.0);
+  double const ks= (sum != 0.0 ? 1.0 / sum : 0.0);
+  double const kf= (factor != 0.0 ? 1.0 / factor : 0.0);
+  vector<int> outer({0}); // Start of each row, then number of springs.
+  vector<int> inner; // Column of each spring.
+  vector<double> value; // Constant of each spring.
+  for(int i= 0; i < m; ++i) {
+    for(int a= p.outer_[i]; a < p.outer_[i + 1]; ++a) {
+      double k= (p.edge_[a] ? ke : 0.0);
+      k+= ks * p.sum_[a];
+      k+= kf * p.factor_[a];
+      if(k == 0.0) continue;
+      inner.push_back(p.inner_[a]);
+      value.push_back(k);
+    }
+    outer.push_back(inner.size());
+  }
+  k_= Eigen::Map<matrix const>(
+      m, m, inner.size(), outer.data(), inner.data(), value.data());
+}
+
+
+springs::springs(squares const &g,
+    double edge,
+    double sum,
+    double factor,
+    vector<int> const &nodes):
+    springs(g, edge, sum, factor) {
+  if(nodes.empty()) return;
+  int const n= nodes.size();
+  vector<int> index(g.modulus, -1); // Offset in subset of each node.
+  for(int a= 0; a < n; ++a) index[nodes[a]]= a;
+  vector<int> outer({0});
+  vector<int> inner;
+  vector<double> value;
+  for(int i: nodes) {
+    for(matrix::InnerIterator s(k_, i); s; ++s) {
+      // Order is preserved, because nodes be increasing.
+      if(index[s.col()] < 0) continue;
+      inner.push_back(index[s.col()]);
+      value.push_back(s.value());
+    }
+    outer.push_back(inner.size());
+  }
+  k_= Eigen::Map<matrix const>(
+      n, n, inner.size(), outer.data(), inner.data(), value.data());
+}
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,104 @@
+/// @file       springs.hpp
+/// @brief      Declaration of modgraph::springs.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include <eigen3/Eigen/Sparse> // SparseMatrix
+#include <vector> // vector
+
+namespace modgraph {
+
+
+class squares;
+
+
+/// Every pair of nodes that any enabled rule might attract, with share of
+/// attraction by each rule at unit scale.
+/// - Pattern depends only on modulus; so sweep over strengths finds it once,
+///   and springs of each variant only rescale it.
+class spring_pattern {
+  friend class springs;
+
+  std::vector<int> outer_; ///< Start of each row, then number of pairs.
+  std::vector<int> inner_; ///< Column j > i of each pair.
+  std::vector<char> edge_; ///< 1 if pair be joined by directed edge.
+  std::vector<double> sum_; ///< Weight of (i + j) % m.
+  std::vector<double> factor_; ///< Sum of weights of both nodes.
+
+public:
+  /// Find every pair that enabled rules might attract.
+  /// @param g  Reference to tables of graph whose nodes are attracted.
+  /// @param edge  True if attraction along edge be enabled.
+  /// @param sum  True if attraction by sum be enabled.
+  /// @param factor  True if attraction by factor be enabled.
+  spring_pattern(squares const &g,
+      bool edge= true,
+      bool sum= true,
+      bool factor= true);
+};
+
+
+/// Sparse list of springs, each attracting one pair of nodes.
+/// - Springs depend only on modulus and on strengths of attraction, never on
+///   positions; so list is built once, before minimization.
+/// - Spring between Node i and Node j (i < j) is stored once, in row i of
+///   compressed, row-major (CSR) matrix whose value is spring-constant.
+/// - When several rules attract same pair, their spring-constants are summed
+///   into single entry.
+/// - Each row is built directly from graph's dense tables of weights, by
+///   visiting only nodes that might be attracted, so that no list of
+///   duplicate triplets is ever made.
+class springs {
+public:
+  /// Row-major sparse matrix whose entry (i, j) is spring-constant between
+  /// Node i and Node j > i.
+  using matrix= Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+private:
+  matrix k_; ///< Spring-constant for each attracted pair.
+
+public:
+  /// Build list of springs for graph.
+  /// - Rule whose scale be zero is disabled; it neither contributes to any
+  ///   spring-constant nor causes any pair to be visited.
+  /// @param g  Reference to tables of graph whose nodes are attracted.
+  /// @param edge  Scale of attraction along directed edge.
+  /// @param sum  Relative scale of attraction by sum of offsets.
+  /// @param factor  Relative scale of attraction by factor of modulus.
+  springs(squares const &g, double edge, double sum, double factor);
+
+  /// Build list of springs by rescaling pattern.
+  /// - Same list results as from tables, because pair outside pattern of
+  ///   enabled rules gets zero spring-constant and is dropped.
+  /// @param p  Pattern of every pair that might be attracted.
+  /// @param edge  Scale of attraction along directed edge.
+  /// @param sum  Relative scale of attraction by sum of offsets.
+  /// @param factor  Relative scale of attraction by factor of modulus.
+  springs(spring_pattern const &p, double edge, double sum, double factor);
+
+  /// Build list of springs among subset of nodes of graph.
+  /// - Node `nodes[a]` of graph becomes Node `a` of list; so every spring
+  ///   to node outside subset is dropped.
+  /// @param g  Reference to tables of graph whose nodes are attracted.
+  /// @param edge  Scale of attraction along directed edge.
+  /// @param sum  Relative scale of attraction by sum of offsets.
+  /// @param factor  Relative scale of attraction by factor of modulus.
+  /// @param nodes  Nodes of subset, in increasing order, or empty for every
+  ///               node.
+  springs(squares const &g,
+      double edge,
+      double sum,
+      double factor,
+      std::vector<int> const &nodes);
+
+  /// Row-major sparse matrix whose entry (i, j) is spring-constant between
+  /// Node i and Node j > i.
+  /// @return  Matrix of spring-constants.
+  matrix const &k() const { return k_; }
+};
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,135 @@
+/// @file       sweep.cpp
+/// @brief      Definition of modgraph::sweep().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "sweep.hpp"
+#include "layout-cache.hpp" // layout_key
+#include "scheduler.hpp" // scheduler
+#include <algorithm> // max
+#include <cstdio> // snprintf
+#include <functional> // function
+#include <iostream> // cout, endl
+#include <limits> // numeric_limits
+#include <sstream> // ostringstream
+
+using Eigen::Matrix3Xd;
+using std::string;
+using std::vector;
+
+
+namespace modgraph {
+
+
+vector<strengths> grid(vector<double> const &edge,
+    vector<double> const &sum,
+    vector<double> const &factor) {
+  vector<strengths> r; // Return-value.
+  for(double e: edge) {
+    for(double s: sum) {
+      for(double f: factor) r.push_back({e, s, f});
+    }
+  }
+  return r;
+}
+
+
+string sweep_stem(int m, strengths const &s) {
+  char b[128];
+  std::snprintf(
+      b, sizeof(b), "%d-e%g-s%g-f%g", m, s.edge, s.sum, s.factor);
+  return b;
+}
+
+
+/// For each variant, index of variant from whose layout it starts, or -1
+/// for first; and depth of variant in tree so formed.
+/// @param k  Key of each variant.
+/// @param parent  On return, index of parent of each variant.
+/// @param depth  On return, depth of each variant; root has depth 0.
+void spanning_tree(
+    vector<layout_key> const &k, vector<int> &parent, vector<int> &depth) {
+  int const n= k.size();
+  parent.assign(n, -1);
+  depth.assign(n, 0);
+  if(n == 0) return;
+  // Root is variant of least total distance to every other.
+  int root= 0;
+  double least= std::numeric_limits<double>::infinity();
+  for(int i= 0; i < n; ++i) {
+    double d= 0.0;
+    for(int j= 0; j < n; ++j) d+= k[i].distance(k[j]);
+    if(d < least) {
+      least= d;
+      root= i;
+    }
+  }
+  // Prim's algorithm: attach nearest remaining variant to nearest variant
+  // already in tree.
+  double const inf= std::numeric_limits<double>::infinity();
+  vector<double> dist(n, inf); // Distance of each variant from tree.
+  vector<bool> in(n, false); // True if variant be in tree.
+  int next= root;
+  for(int added= 0; added < n; ++added) {
+    int const a= next;
+    in[a]= true;
+    if(parent[a] >= 0) depth[a]= depth[parent[a]] + 1;
+    next= -1;
+    for(int j= 0; j < n; ++j) {
+      if(in[j]) continue;
+      double const d= k[a].distance(k[j]);
+      if(d < dist[j]) {
+        dist[j]= d;
+        parent[j]= a;
+      }
+      if(next < 0 || dist[j] < dist[next]) next= j;
+    }
+  }
+}
+
+
+void sweep(squares const &g,
+    options const &o,
+    vector<strengths> const &v,
+    int jobs) {
+  int const n= v.size();
+  int const m= g.modulus;
+  spring_pattern const pattern(g); // Every rule, for every variant.
+  vector<layout_key> keys;
+  for(auto const &s: v) keys.push_back({m, s.edge, s.sum, s.factor, o.theta});
+  vector<int> parent, depth;
+  spanning_tree(keys, parent, depth);
+  int waves= 0;
+  for(int d: depth) waves= std::max(waves, d + 1);
+  vector<Matrix3Xd> final(n); // Final positions of each variant.
+  for(int w= 0; w < waves; ++w) {
+    vector<std::function<void()>> tasks;
+    for(int i= 0; i < n; ++i) {
+      if(depth[i] != w) continue;
+      tasks.push_back([&, i] {
+        options vo= o;
+        vo.edge_attract= v[i].edge;
+        vo.sum_attract= v[i].sum;
+        vo.factor_attract= v[i].factor;
+        minimizer mz(g, pattern, vo);
+        if(parent[i] >= 0) mz.warm_start(final[parent[i]]);
+        mz.go();
+        final[i]= mz.positions();
+        string const stem= sweep_stem(m, v[i]);
+        g.write(final[i], stem, o.format);
+        // Whole line at once, lest lines from concurrent variants interleave.
+        std::ostringstream os;
+        os << stem << ": f()=" << mz.potential() << " iterations "
+           << mz.iterations() << (mz.converged() ? "" : " (not converged)");
+        if(parent[i] >= 0) os << " from " << sweep_stem(m, v[parent[i]]);
+        os << '\n';
+        std::cout << os.str() << std::flush;
+      });
+    }
+    scheduler(jobs).run(std::move(tasks));
+  }
+}
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,64 @@
+/// @file       sweep.hpp
+/// @brief      Declaration of modgraph::sweep().
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include "graph.hpp" // graph
+#include "options.hpp" // options
+#include <string> // string
+#include <vector> // vector
+
+namespace modgraph {
+
+
+/// Strengths of attraction for one variant of sweep.
+struct strengths {
+  double edge; ///< Scale of attraction along directed edge.
+  double sum; ///< Relative scale of attraction by sum.
+  double factor; ///< Relative scale of attraction by factor.
+};
+
+
+/// Every combination of given scales, with factor varying fastest.
+/// @param edge  Scales of attraction along directed edge.
+/// @param sum  Relative scales of attraction by sum.
+/// @param factor  Relative scales of attraction by factor.
+/// @return  Grid of variants.
+std::vector<strengths> grid(std::vector<double> const &edge,
+    std::vector<double> const &sum,
+    std::vector<double> const &factor);
+
+
+/// Name of scene, without extension, for variant of modulus `m`.
+/// @param m  Modulus.
+/// @param s  Strengths of variant.
+/// @return  Stem like "33-e1.5-s15-f150".
+std::string sweep_stem(int m, strengths const &s);
+
+
+/// Lay out graph once for each variant, and write one scene per variant.
+/// - Tables of graph (successors, predecessors, factors, and weights) and
+///   pattern of springs are built once and shared by every variant; springs
+///   of each variant only rescale pattern.  No minimizer is built but for
+///   variants.
+/// - Variant nearest middle of grid (of least total distance to every other
+///   variant, as by layout_key::distance()) starts from random positions;
+///   each other variant starts from final positions of its nearest
+///   neighbour among variants laid out before it (as by minimum spanning
+///   tree).
+/// - Variants are laid out in waves, each wave holding every variant whose
+///   neighbour be done, and variants within wave run concurrently.
+/// @param g  Tables of graph, shared by every variant.
+/// @param o  Options common to every variant; strengths are overridden.
+/// @param v  Variants.
+/// @param jobs  Number of variants laid out concurrently.
+void sweep(squares const &g,
+    options const &o,
+    std::vector<strengths> const &v,
+    int jobs);
+
+
+} // namespace modgraph
+
+// EOF
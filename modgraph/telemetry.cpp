@@ -0,0 +1,177 @@
+/// @file       telemetry.cpp
+/// @brief      Definition of modgraph::telemetry.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "telemetry.hpp"
+#include <algorithm> // max
+#include <cerrno> // errno
+#include <cstring> // strerror
+#include <iostream> // cerr, endl
+#include <mutex> // call_once, once_flag
+
+using std::string;
+
+
+namespace modgraph {
+
+
+/// First line of CSV-sink.
+static char const csv_header[]=
+    "modulus,iteration,calls_f,calls_df,calls_fdf,seconds_f,seconds_df,"
+    "seconds_fdf,potential,measure,final,converged\n";
+
+
+telemetry::telemetry(int modulus,
+    string const &fmt,
+    string const &path,
+    int every,
+    progress_callback cb):
+    modulus_(modulus),
+    every_(std::max(every, 1)),
+    callback_(std::move(cb)),
+    timed_(fmt != "none" || callback_) {
+  if(fmt == "none") {
+    format_= NONE;
+  } else if(fmt == "csv") {
+    format_= CSV;
+  } else if(fmt == "json") {
+    format_= JSON;
+  }
+  if(format_ == NONE) return;
+  if(path.empty()) {
+    file_= stdout;
+    // Header only once per process, however many graphs be laid out.
+    static std::once_flag header;
+    if(format_ == CSV) {
+      std::call_once(header, [this] { std::fputs(csv_header, file_); });
+    }
+    return;
+  }
+  file_= std::fopen(path.c_str(), "a");
+  if(!file_) {
+    std::cerr << "telemetry: cannot open '" << path
+              << "': " << std::strerror(errno) << std::endl;
+    return;
+  }
+  own_= true;
+  // Header only at beginning of new file, because concurrent minimizations
+  // may append to same file.
+  if(format_ == CSV && std::ftell(file_) == 0) {
+    std::fputs(csv_header, file_);
+    std::fflush(file_);
+  }
+}
+
+
+telemetry::~telemetry() {
+  if(own_) std::fclose(file_);
+}
+
+
+bool telemetry::known_format(string const &fmt) {
+  return fmt == "text" || fmt == "csv" || fmt == "json" || fmt == "none";
+}
+
+
+void telemetry::emit(progress const &p) {
+  if(callback_) callback_(p);
+  if(!file_) return;
+  char b[512];
+  int n= 0;
+  switch(format_) {
+    case TEXT:
+      n= std::snprintf(b,
+          sizeof(b),
+          "%d: %5d f()=%8.4f measure=%.3g calls=%d/%d/%d%s\n",
+          p.modulus,
+          p.iteration,
+          p.potential,
+          p.measure,
+          p.calls_f,
+          p.calls_df,
+          p.calls_fdf,
+          p.final ? (p.converged ? " converged" : " not converged") : "");
+      break;
+    case CSV:
+      n= std::snprintf(b,
+          sizeof(b),
+          "%d,%d,%d,%d,%d,%.6g,%.6g,%.6g,%.10g,%.6g,%d,%d\n",
+          p.modulus,
+          p.iteration,
+          p.calls_f,
+          p.calls_df,
+          p.calls_fdf,
+          p.seconds_f,
+          p.seconds_df,
+          p.seconds_fdf,
+          p.potential,
+          p.measure,
+          p.final,
+          p.converged);
+      break;
+    case JSON:
+      // One object per line (JSON Lines).
+      n= std::snprintf(b,
+          sizeof(b),
+          "{\"modulus\":%d,\"iteration\":%d,\"calls_f\":%d,\"calls_df\":%d,"
+          "\"calls_fdf\":%d,\"seconds_f\":%.6g,\"seconds_df\":%.6g,"
+          "\"seconds_fdf\":%.6g,\"potential\":%.10g,\"measure\":%.6g,"
+          "\"final\":%s,\"converged\":%s}\n",
+          p.modulus,
+          p.iteration,
+          p.calls_f,
+          p.calls_df,
+          p.calls_fdf,
+          p.seconds_f,
+          p.seconds_df,
+          p.seconds_fdf,
+          p.potential,
+          p.measure,
+          p.final ? "true" : "false",
+          p.converged ? "true" : "false");
+      break;
+    case NONE: return;
+  }
+  std::fwrite(b, 1, std::min<int>(n, sizeof(b) - 1), file_);
+  if(own_) std::fflush(file_);
+}
+
+
+void telemetry::report(
+    int iter, double pot, double measure, bool final, bool converged) {
+  if(!file_ && !callback_ && !(final && deferred_)) return;
+  if(iter == last_ && !final) return;
+  last_= iter;
+  progress const p{modulus_,
+      iter,
+      calls_[POTENTIAL],
+      calls_[FORCES],
+      calls_[BOTH],
+      seconds_[POTENTIAL],
+      seconds_[FORCES],
+      seconds_[BOTH],
+      pot,
+      measure,
+      final,
+      converged};
+  if(final && deferred_) {
+    pending_= p;
+    held_= true;
+    return;
+  }
+  emit(p);
+}
+
+
+void telemetry::release(telemetry const &kept) {
+  deferred_= false;
+  if(!kept.held_ || (!file_ && !callback_)) return;
+  progress p= kept.pending_;
+  p.modulus= modulus_;
+  emit(p);
+}
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,145 @@
+/// @file       telemetry.hpp
+/// @brief      Declaration of modgraph::progress and modgraph::telemetry.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include "repulsion.hpp" // quantities
+#include <chrono> // steady_clock
+#include <cstdio> // FILE
+#include <functional> // function
+#include <string> // string
+
+namespace modgraph {
+
+
+/// Snapshot of progress of minimization.
+struct progress {
+  int modulus; ///< Modulus of graph being laid out.
+  int iteration; ///< Number of iterations of GSL's minimizer so far.
+  int calls_f; ///< Number of calls to f() (potential only).
+  int calls_df; ///< Number of calls to df() (forces only).
+  int calls_fdf; ///< Number of calls to fdf() (potential and forces).
+  double seconds_f; ///< Time spent in f().
+  double seconds_df; ///< Time spent in df().
+  double seconds_fdf; ///< Time spent in fdf().
+  double potential; ///< Current potential.
+  double measure; ///< Norm of gradient, or size of simplex (nmsimplex2).
+  bool final; ///< True for last snapshot of minimization.
+  bool converged; ///< True if minimization converged.
+};
+
+
+/// Function called with each snapshot of progress.
+using progress_callback= std::function<void(progress const &)>;
+
+
+/// Reporter of progress of minimization, at configurable cadence, to sink
+/// for text, CSV, or JSON, and to optional callback.
+/// - Each record is formatted into local buffer and written by one call,
+///   so that records from concurrent minimizations never interleave.
+/// - When format be "none" and no callback be given, nothing is timed, and
+///   only counting of calls remains on hot path.
+class telemetry {
+public:
+  using clock= std::chrono::steady_clock; ///< Clock for timing calls.
+
+private:
+  enum format { NONE, TEXT, CSV, JSON };
+
+  int const modulus_; ///< Modulus of graph being laid out.
+  format format_= TEXT; ///< Format of sink.
+  int const every_; ///< Number of iterations between reports.
+  progress_callback const callback_; ///< Callback, or empty.
+  bool const timed_; ///< True if calls be timed.
+  std::FILE *file_= nullptr; ///< Sink, or null for none.
+  bool own_= false; ///< True if file_ should be closed by destructor.
+  int calls_[4]= {}; ///< Calls for each value of quantities.
+  double seconds_[4]= {}; ///< Time for each value of quantities.
+  int last_= -1; ///< Last iteration reported.
+  bool deferred_= false; ///< True if final snapshot be withheld.
+  progress pending_{}; ///< Final snapshot withheld, if any.
+  bool held_= false; ///< True if pending_ hold snapshot.
+
+  /// Write snapshot to sink and to callback.
+  /// @param p  Snapshot.
+  void emit(progress const &p);
+
+public:
+  /// Choose sink.
+  /// @param modulus  Modulus of graph being laid out.
+  /// @param fmt  Format: "text", "csv", "json", or "none".
+  /// @param path  File to which records are appended, or empty for stdout.
+  /// @param every  Number of iterations between reports (at least 1).
+  /// @param cb  Callback for every report, or empty.
+  telemetry(int modulus,
+      std::string const &fmt,
+      std::string const &path,
+      int every,
+      progress_callback cb);
+
+  /// Close file, if any were opened.
+  ~telemetry();
+
+  telemetry(telemetry const &)= delete;
+  telemetry &operator=(telemetry const &)= delete;
+
+  /// True if format name be known.
+  /// @param fmt  Name of format.
+  /// @return  True for "text", "csv", "json", or "none".
+  static bool known_format(std::string const &fmt);
+
+  /// Time at start of call, or zero time if calls be not timed.
+  /// @return  Time at start of call.
+  clock::time_point start() const {
+    return timed_ ? clock::now() : clock::time_point();
+  }
+
+  /// Account for call that began at `t0`.
+  /// @param q  Quantities computed by call.
+  /// @param t0  Return-value of start() at beginning of call.
+  void finish(quantities q, clock::time_point t0) {
+    ++calls_[q];
+    if(timed_) {
+      std::chrono::duration<double> const d= clock::now() - t0;
+      seconds_[q]+= d.count();
+    }
+  }
+
+  /// Number of calls that computed `q`.
+  /// @param q  Quantities.
+  /// @return  Number of calls.
+  int calls(quantities q) const { return calls_[q]; }
+
+  /// True if report be due at iteration `iter`.
+  /// - Typical caller computes measure only when report be due.
+  /// @param iter  Number of iterations so far.
+  /// @return  True if report should be made.
+  bool due(int iter) const {
+    return (file_ || callback_) && iter % every_ == 0;
+  }
+
+  /// Report snapshot.
+  /// @param iter  Number of iterations so far.
+  /// @param pot  Current potential.
+  /// @param measure  Norm of gradient, or size of simplex.
+  /// @param final  True after last iteration.
+  /// @param converged  True if minimization converged.
+  void report(
+      int iter, double pot, double measure, bool final, bool converged);
+
+  /// Withhold final snapshot, as when several starts race and start to be
+  /// kept be not yet known.
+  void defer() { deferred_= true; }
+
+  /// Stop withholding, and report final snapshot withheld by kept start.
+  /// - Snapshot, including numbers of calls and their times, is that of
+  ///   `kept`, which may be this reporter.
+  /// @param kept  Reporter of kept start.
+  void release(telemetry const &kept);
+};
+
+
+} // namespace modgraph
+
+// EOF
@@ -0,0 +1,77 @@
+/// @file       thread-pool.cpp
+/// @brief      Definition of modgraph::thread_pool.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#include "thread-pool.hpp"
+
+using std::unique_lock;
+
+
+namespace modgraph {
+
+
+void thread_pool::work(int t) {
+  unsigned seen= 0; // Generation of last task run by this thread.
+  for(;;) {
+    std::function<void(int)> const *task;
+    {
+      unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if(stop_) return;
+      seen= generation_;
+      task= task_;
+    }
+    try {
+      (*task)(t);
+    } catch(...) {
+      unique_lock<std::mutex> lock(mutex_);
+      if(!error_) error_= std::current_exception();
+    }
+    unique_lock<std::mutex> lock(mutex_);
+    if(--pending_ == 0) done_.notify_one();
+  }
+}
+
+
+thread_pool::thread_pool(int n) {
+  for(int t= 1; t < n; ++t) workers_.emplace_back(&thread_pool::work, this, t);
+}
+
+
+thread_pool::~thread_pool() {
+  {
+    unique_lock<std::mutex> lock(mutex_);
+    stop_= true;
+  }
+  start_.notify_all();
+  for(auto &w: workers_) w.join();
+}
+
+
+void thread_pool::run(std::function<void(int)> const &task) {
+  if(workers_.empty()) {
+    task(0);
+    return;
+  }
+  {
+    unique_lock<std::mutex> lock(mutex_);
+    task_= &task;
+    pending_= int(workers_.size());
+    error_= nullptr;
+    ++generation_;
+  }
+  start_.notify_all();
+  std::exception_ptr e;
+  try {
+    task(0);
+  } catch(...) { e= std::current_exception(); }
+  unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [&] { return pending_ == 0; });
+  if(!e) e= error_;
+  if(e) std::rethrow_exception(e);
+}
+
+
+} // namespace modgraph
+
+// EOF
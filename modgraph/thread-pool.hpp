@@ -0,0 +1,62 @@
+/// @file       thread-pool.hpp
+/// @brief      Declaration of modgraph::thread_pool.
+/// @copyright  2022 Thomas E. Vaughan, all rights reserved.
+
+#pragma once
+
+#include <condition_variable> // condition_variable
+#include <exception> // exception_ptr
+#include <functional> // function
+#include <mutex> // mutex
+#include <thread> // thread
+#include <vector> // vector
+
+namespace modgraph {
+
+
+/// Fixed set of threads that repeatedly run same task together.
+/// - Each call to run() hands every thread its own index, so that work can be
+///   divided among threads in fixed, reproducible way.
+/// - Calling thread takes index 0 and participates in work; so a pool of size
+///   one starts no extra thread at all.
+class thread_pool {
+  std::vector<std::thread> workers_; ///< Threads besides the calling thread.
+  std::mutex mutex_; ///< Guard for every member below.
+  std::condition_variable start_; ///< Signal to workers that task be ready.
+  std::condition_variable done_; ///< Signal to run() that workers be done.
+  std::function<void(int)> const *task_= nullptr; ///< Current task.
+  unsigned generation_= 0; ///< Number of tasks started so far.
+  int pending_= 0; ///< Number of workers still running current task.
+  bool stop_= false; ///< True when workers should exit.
+  std::exception_ptr error_; ///< First exception thrown by worker.
+
+  /// Loop run by each worker-thread.
+  /// @param t  Index of thread.
+  void work(int t);
+
+public:
+  /// Start threads.
+  /// @param n  Total number of threads, including calling thread.
+  thread_pool(int n);
+
+  /// Stop and join threads.
+  ~thread_pool();
+
+  thread_pool(thread_pool const &)= delete;
+  thread_pool &operator=(thread_pool const &)= delete;
+
+  /// Total number of threads, including calling thread.
+  /// @return  Total number of threads.
+  int size() const { return int(workers_.size()) + 1; }
+
+  /// Call `task(t)` once for every thread-index t in [0, size()), each on its
+  /// own thread, and wait for every call to return.
+  /// - If any call throw, then first exception is rethrown here.
+  /// @param task  Function to run on every thread.
+  void run(std::function<void(int)> const &task);
+};
+
+
+} // namespace modgraph
+
+// EOF